@@ -6,7 +6,8 @@ struct CC {
   ns::deque<int> id;
   int count;
 
-  CC(const Graph &G) : marked(G.V, false), id(G.V), count{0} {
+  template <isAdjacency Adj>
+  CC(const Adj &G) : marked(G.V, false), id(G.V), count{0} {
     for (int v = 0; v < G.V; ++v)
       if (!marked[v]) {
         bfs(G, v);
@@ -14,7 +15,8 @@ struct CC {
       }
   }
 
-  void dfs(const Graph &G, int v) {
+  template <isAdjacency Adj>
+  void dfs(const Adj &G, int v) {
     // 首次发现时标记顶点
     marked[v] = true;
     id[v] = count;
@@ -23,7 +25,8 @@ struct CC {
     }
   }
 
-  void bfs(const Graph &G, int s) {
+  template <isAdjacency Adj>
+  void bfs(const Adj &G, int s) {
     // 首次发现时标记顶点
     marked[s] = true;
     id[s] = count;
@@ -101,6 +104,10 @@ int main() {
     printCC(cc, G.V);
     std::print("\n");
 
+    CC csr(CSRGraph<int>{G});
+    assert(csr.count == cc.count);
+    for (int i = 0; i < v; i++) assert(csr.id[i] == cc.id[i]);
+
     Articulation A(G);
     std::print("vertex\t");
     for (int i = 0; i < v; i++) std::print("{}\t", i);
@@ -6,13 +6,14 @@ struct DepthFirstOrder {
   ns::deque<int> preorder;
   ns::deque<int> postorder;
 
-  DepthFirstOrder(const Digraph &G)
-      : marked(G.V, false), preorder(), postorder() {
+  template <isAdjacency Adj>
+  DepthFirstOrder(const Adj &G) : marked(G.V, false), preorder(), postorder() {
     for (int v = 0; v < G.V; ++v)
       if (!marked[v]) dfs(G, v);
   }
 
-  void dfs(const Digraph &G, int v) {
+  template <isAdjacency Adj>
+  void dfs(const Adj &G, int v) {
     preorder.push_back(v);
     marked[v] = true;
     for (int w : G.adj[v]) {
@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <print>
+#include <random>
+#include <string>
+
+#include "FMIndex.hh"
+
+int main() {
+  std::mt19937 mt(std::random_device{}());
+  auto randomString = [&](int n, int alphabet) {
+    std::uniform_int_distribution<int> c(0, alphabet - 1);
+    std::string s(n, ' ');
+    // byte 0 included, it must not be confused with $
+    for (auto &x : s) x = alphabet == 256 ? c(mt) : 'a' + c(mt);
+    return s;
+  };
+  auto occurrences = [](std::string_view pat, std::string_view txt) {
+    std::vector<int> at;
+    for (auto i{txt.find(pat)}; i != txt.npos; i = txt.find(pat, i + 1))
+      at.push_back(i);
+    return at;
+  };
+
+  for (int trial = 0; trial < 300; trial++) {
+    int alphabet{std::array{1, 2, 4, 256}[trial % 4]};
+    auto txt{randomString(mt() % 500, alphabet)};
+    FMIndex fm(txt, 1 + mt() % 16);
+    for (int q = 0; q < 20; q++) {
+      std::string pat;
+      if (q % 2 && !txt.empty()) {
+        auto at{mt() % txt.size()};
+        pat = txt.substr(at, 1 + mt() % 8);
+      } else
+        pat = randomString(1 + mt() % 4, alphabet);
+      auto expected{occurrences(pat, txt)};
+      assert(fm.count(pat) == expected.size());
+      auto found{fm.locate(pat)};
+      std::ranges::sort(found);
+      assert(found == expected);
+    }
+  }
+
+  // memory against locate time over the sampling rate
+  auto txt{randomString(1 << 20, 4)};
+  std::vector<std::string> pats;
+  for (int q = 0; q < 1000; q++)
+    pats.push_back(txt.substr(mt() % (txt.size() - 12), 12));
+  std::print("text {} bytes, suffix array {} bytes\n", txt.size(),
+             txt.size() * sizeof(int));
+  for (int rate : {1, 4, 16, 64}) {
+    FMIndex fm(txt, rate);
+    std::size_t hits{0};
+    auto start{std::chrono::steady_clock::now()};
+    for (const auto &pat : pats) hits += fm.locate(pat).size();
+    std::chrono::duration<double, std::micro> elapsed{
+        std::chrono::steady_clock::now() - start};
+    std::print("rate {}\t{} bytes\t{:.2f} us/hit\n", rate, fm.bytes(),
+               elapsed.count() / hits);
+  }
+}
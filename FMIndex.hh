@@ -0,0 +1,192 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "SuffixArray.hh"
+
+// bit vector with rank in O(1), one cumulative count per 512 bits
+struct RankBits {
+  std::vector<std::uint64_t> words, blocks;
+
+  RankBits() = default;
+  explicit RankBits(std::size_t n) : words(n / 64 + 1) {}
+
+  void set(std::size_t i) { words[i / 64] |= 1ull << i % 64; }
+  bool get(std::size_t i) const { return words[i / 64] >> i % 64 & 1; }
+
+  void build() {
+    blocks.assign(words.size() / 8 + 1, 0);
+    for (std::size_t b = 0; b + 1 < blocks.size(); b++) {
+      std::uint64_t sum{blocks[b]};
+      for (std::size_t w = b * 8; w < b * 8 + 8 && w < words.size(); w++)
+        sum += std::popcount(words[w]);
+      blocks[b + 1] = sum;
+    }
+  }
+
+  // ones in [0, i)
+  std::size_t rank1(std::size_t i) const {
+    std::size_t w{i / 64}, r = blocks[w / 8];
+    for (std::size_t k = w / 8 * 8; k < w; k++) r += std::popcount(words[k]);
+    if (i % 64) r += std::popcount(words[w] << (64 - i % 64));
+    return r;
+  }
+  std::size_t rank0(std::size_t i) const { return i - rank1(i); }
+
+  std::size_t bytes() const { return (words.size() + blocks.size()) * 8; }
+};
+
+// wavelet matrix (Claude, Navarro & Ordonez) over bytes, one level per bit
+// from the top; level l stably moves the symbols whose bit is 0 in front,
+// so rank and access follow a symbol down with one bit rank per level
+struct WaveletMatrix {
+  std::size_t n{0};
+  std::array<RankBits, 8> level;
+  std::array<std::size_t, 8> zeros{};
+  // where the run of each symbol starts below the last level
+  std::array<std::size_t, 256> begin{};
+
+  WaveletMatrix() = default;
+  explicit WaveletMatrix(std::span<const unsigned char> s) : n{s.size()} {
+    std::vector<unsigned char> cur(s.begin(), s.end()), next(n);
+    for (int l = 0; l < 8; l++) {
+      int bit{7 - l};
+      level[l] = RankBits(n);
+      std::size_t z{0};
+      for (std::size_t i = 0; i < n; i++)
+        if (cur[i] >> bit & 1) level[l].set(i);
+        else z++;
+      level[l].build();
+      zeros[l] = z;
+      std::size_t lo{0}, hi{z};
+      for (std::size_t i = 0; i < n; i++)
+        next[cur[i] >> bit & 1 ? hi++ : lo++] = cur[i];
+      cur.swap(next);
+    }
+    for (int c = 0; c < 256; c++) begin[c] = down(c, 0);
+  }
+
+  std::size_t down(unsigned char c, std::size_t i) const {
+    for (int l = 0; l < 8; l++)
+      i = c >> (7 - l) & 1 ? zeros[l] + level[l].rank1(i) : level[l].rank0(i);
+    return i;
+  }
+
+  // occurrences of c in [0, i)
+  std::size_t rank(unsigned char c, std::size_t i) const {
+    return down(c, i) - begin[c];
+  }
+
+  // the symbol at i and its occurrences in [0, i)
+  std::pair<unsigned char, std::size_t> inverseSelect(std::size_t i) const {
+    unsigned c{0};
+    for (int l = 0; l < 8; l++) {
+      bool b{level[l].get(i)};
+      c = c << 1 | b;
+      i = b ? zeros[l] + level[l].rank1(i) : level[l].rank0(i);
+    }
+    return {(unsigned char)c, i - begin[c]};
+  }
+
+  std::size_t bytes() const {
+    std::size_t total{sizeof(*this)};
+    for (const auto &bits : level) total += bits.bytes();
+    return total;
+  }
+};
+
+// FM-index (Ferragina & Manzini) over text + $, $ below every byte
+// count runs backward search over the BWT held in a wavelet matrix; locate
+// walks LF from each row to the nearest sampled suffix, one in every
+// sampleRate text positions, so memory falls and locate slows as the rate
+// grows. The full suffix array only exists while building
+template <std::signed_integral Index = std::int32_t>
+struct FMIndex {
+  std::size_t n{0};
+  // row of the suffix starting at 0, whose BWT symbol is $
+  std::size_t dollar{0};
+  int sampleRate{1};
+  // symbols below c, counting $
+  std::array<std::size_t, 257> C{};
+  WaveletMatrix bwt;
+  RankBits sampled;
+  std::vector<Index> samples;
+
+  explicit FMIndex(std::string_view text, int sampleRate = 32)
+      : n{text.size() + 1}, sampleRate{sampleRate} {
+    assert(sampleRate > 0);
+    std::vector<short> s(n);
+    for (std::size_t i = 0; i + 1 < n; i++) s[i] = (unsigned char)text[i] + 1;
+    auto sa{sais<Index>(std::span<const short>(s), 256)};
+
+    std::vector<unsigned char> last(n);
+    sampled = RankBits(n);
+    for (std::size_t k = 0; k < n; k++) {
+      if (sa[k] == 0) dollar = k;
+      else last[k] = s[sa[k] - 1] - 1;
+      if (sa[k] % sampleRate == 0) sampled.set(k);
+    }
+    sampled.build();
+    samples.reserve(sampled.rank1(n));
+    for (std::size_t k = 0; k < n; k++)
+      if (sa[k] % sampleRate == 0) samples.push_back(sa[k]);
+    bwt = WaveletMatrix(last);
+
+    C[0] = 1;
+    for (std::size_t i = 0; i + 1 < n; i++) C[s[i]]++;
+    for (int c = 1; c <= 256; c++) C[c] += C[c - 1];
+    // C[c] now counts symbols <= c - 1, that is below byte c
+  }
+
+  // occurrences of byte c in BWT[0, i), not counting $ at row dollar
+  std::size_t occ(unsigned char c, std::size_t i) const {
+    return bwt.rank(c, i) - (c == 0 && dollar < i);
+  }
+
+  // rows [lo, hi) of the suffixes prefixed by pattern
+  std::pair<std::size_t, std::size_t> range(std::string_view pattern) const {
+    std::size_t lo{0}, hi{n};
+    for (auto k = pattern.size(); k-- > 0 && lo < hi;) {
+      unsigned char c = pattern[k];
+      lo = C[c] + occ(c, lo);
+      hi = C[c] + occ(c, hi);
+    }
+    return {lo, std::max(lo, hi)};
+  }
+
+  std::size_t count(std::string_view pattern) const {
+    auto [lo, hi]{range(pattern)};
+    return hi - lo;
+  }
+
+  // text position of the suffix in row k
+  Index position(std::size_t k) const {
+    Index steps{0};
+    while (!sampled.get(k)) {
+      auto [c, r]{bwt.inverseSelect(k)};
+      k = C[c] + r - (c == 0 && dollar < k);
+      steps++;
+    }
+    return samples[sampled.rank1(k)] + steps;
+  }
+
+  // every position of pattern, in suffix order
+  std::vector<Index> locate(std::string_view pattern) const {
+    auto [lo, hi]{range(pattern)};
+    std::vector<Index> out;
+    out.reserve(hi - lo);
+    for (auto k = lo; k < hi; k++) out.push_back(position(k));
+    return out;
+  }
+
+  std::size_t bytes() const {
+    return sizeof(*this) + bwt.bytes() - sizeof(bwt) + sampled.bytes() +
+           samples.size() * sizeof(Index);
+  }
+};
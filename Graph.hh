@@ -1,10 +1,13 @@
 #pragma once
 #include <cassert>
+#include <concepts>
 #include <print>
 #include <random>
 #include <type_traits>
+#include <utility>
 
 #include "deque.hh"
+#include "vector.hh"
 
 struct Graph {
   int V, E;
@@ -110,6 +113,132 @@ struct EdgeWeightedDigraph {
   }
 };
 
+// compressed sparse row: immutable adjacency packed into two flat arrays
+template <class T>
+struct CSRGraph {
+  struct Row {
+    const T *first, *last;
+    const T *begin() const { return first; }
+    const T *end() const { return last; }
+    int size() const { return last - first; }
+    bool empty() const { return first == last; }
+    const T &operator[](int i) const { return first[i]; }
+  };
+  // adj[v] is target[offset[v]..offset[v+1])
+  struct Adjacency {
+    ns::vector<int> offset;
+    ns::vector<T> target;
+    Row operator[](int v) const {
+      return {target.begin() + offset[v], target.begin() + offset[v + 1]};
+    }
+  };
+  int V, E;
+  Adjacency adj;
+
+  explicit CSRGraph(const Graph &G)
+    requires std::same_as<T, int>
+      : V{G.V}, E{G.E} {
+    pack(G.adj);
+  }
+  explicit CSRGraph(const Digraph &G)
+    requires std::same_as<T, int>
+      : V{G.V}, E{G.E} {
+    pack(G.adj);
+  }
+  explicit CSRGraph(const EdgeWeightedGraph &G)
+    requires std::same_as<T, Edge>
+      : V{G.V}, E{G.E} {
+    pack(G.adj);
+  }
+  explicit CSRGraph(const EdgeWeightedDigraph &G)
+    requires std::same_as<T, DirectedEdge>
+      : V{G.V}, E{G.E} {
+    pack(G.adj);
+  }
+
+  // edge list, undirected edges are stored once per endpoint
+  CSRGraph(int v, const ns::deque<std::pair<int, int>> &edges, bool directed)
+    requires std::same_as<T, int>
+      : V{v}, E{edges.size()} {
+    ns::vector<std::pair<int, int>> arcs;
+    for (const auto &[from, to] : edges) {
+      arcs.push_back(from, to);
+      if (!directed) arcs.push_back(to, from);
+    }
+    pack(arcs);
+  }
+  CSRGraph(int v, const ns::deque<Edge> &edges)
+    requires std::same_as<T, Edge>
+      : V{v}, E{edges.size()} {
+    ns::vector<std::pair<int, Edge>> arcs;
+    for (const auto &e : edges) arcs.push_back(e.v, e), arcs.push_back(e.w, e);
+    pack(arcs);
+  }
+  CSRGraph(int v, const ns::deque<DirectedEdge> &edges)
+    requires std::same_as<T, DirectedEdge>
+      : V{v}, E{edges.size()} {
+    ns::vector<std::pair<int, DirectedEdge>> arcs;
+    for (const auto &e : edges) arcs.push_back(e.from, e);
+    pack(arcs);
+  }
+
+  CSRGraph reverse() const
+    requires std::same_as<T, int> || std::same_as<T, DirectedEdge>
+  {
+    ns::vector<std::pair<int, T>> arcs;
+    arcs.reserve(adj.target.size());
+    for (int v = 0; v < V; v++) {
+      for (const auto &e : adj[v]) {
+        if constexpr (std::same_as<T, int>)
+          arcs.push_back(e, v);
+        else
+          arcs.push_back(e.to, DirectedEdge{e.to, e.from, e.weight});
+      }
+    }
+    return CSRGraph(V, E, arcs);
+  }
+
+ private:
+  CSRGraph(int v, int e, const ns::vector<std::pair<int, T>> &arcs)
+      : V{v}, E{e} {
+    pack(arcs);
+  }
+
+  // copy row by row, neighbor order is preserved
+  void pack(const ns::deque<ns::deque<T>> &lists) {
+    adj.offset = ns::vector<int>(V + 1, 0);
+    for (int v = 0; v < V; v++)
+      adj.offset[v + 1] = adj.offset[v] + lists[v].size();
+    adj.target = ns::vector<T>(adj.offset[V]);
+    for (int v = 0; v < V; v++) {
+      int i{adj.offset[v]};
+      for (const auto &e : lists[v]) adj.target[i++] = e;
+    }
+  }
+
+  // stable counting sort by source, insertion order is preserved per row
+  void pack(const ns::vector<std::pair<int, T>> &arcs) {
+    adj.offset = ns::vector<int>(V + 1, 0);
+    for (const auto &[from, e] : arcs) {
+      assert(0 <= from && from < V);
+      adj.offset[from + 1]++;
+    }
+    for (int v = 0; v < V; v++) adj.offset[v + 1] += adj.offset[v];
+    adj.target = ns::vector<T>(arcs.size());
+    ns::vector<int> next(adj.offset);
+    for (const auto &[from, e] : arcs) adj.target[next[from]++] = e;
+  }
+};
+
+// anything exposing V and a row of neighbors per vertex through adj[v]
+template <class T>
+concept isAdjacency = requires(const T &G, int v) {
+  { G.V } -> std::convertible_to<int>;
+  G.adj[v].begin();
+  G.adj[v].end();
+  { G.adj[v].size() } -> std::convertible_to<int>;
+};
+
 // one generator to rule them all
 #ifdef __cpp_lib_concepts
 template <class T>
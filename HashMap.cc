@@ -1,8 +1,19 @@
+#include <bit>
 #include <cassert>
 #include <concepts>
+#include <cstdint>
 #include <functional>
+#include <mutex>
+#include <optional>
 #include <print>
 #include <random>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 template <class Key, class Value>
   requires std::equality_comparable<Key>
@@ -34,17 +45,37 @@ struct SequentialSearchST {
     return nullptr;
   }
 
-  void insert(Key key, Value val) {
+  // true if key was not present
+  bool insert(Key key, Value val) {
     for (Node *x = first; x; x = x->next)
       if (key == x->key) {
         x->val = val;
-        return;
+        return false;
       }
     first = new Node(key, val, first);
     ++sz;
+    return true;
+  }
+
+  // detach every node, for moving them to another table without copying
+  Node *release() {
+    Node *x{first};
+    first = nullptr;
+    sz = 0;
+    return x;
+  }
+  void link(Node *x) {
+    x->next = first;
+    first = x;
+    ++sz;
   }
 
-  void remove(Key key) { first = remove(first, key); }
+  // true if key was present
+  bool remove(Key key) {
+    int before{sz};
+    first = remove(first, key);
+    return sz < before;
+  }
   Node *remove(Node *x, Key key) {
     if (x == nullptr) return nullptr;
     if (key == x->key) {
@@ -89,6 +120,11 @@ struct HashMap {
   int INIT_CAPACITY{4}, N, M;
   std::hash<Key> hashCode;
   SequentialSearchST<Key, Value> *st;
+  // incremental rehash (rehashStep > 0): resize keeps the old table and
+  // every operation moves at most rehashStep of its buckets into st,
+  // buckets below migrated are already moved
+  int rehashStep{0}, oldM{0}, migrated{0};
+  SequentialSearchST<Key, Value> *old{nullptr};
 
   HashMap()
       : N{0},
@@ -99,39 +135,302 @@ struct HashMap {
   HashMap(int M)
       : N{0}, M{M}, hashCode{}, st{new SequentialSearchST<Key, Value>[M]} {}
 
-  ~HashMap() { delete[] st; }
+  HashMap(int M, int rehashStep) : HashMap(M) { this->rehashStep = rehashStep; }
+
+  ~HashMap() {
+    delete[] st;
+    delete[] old;
+  }
 
   int hash(Key key) const { return (hashCode(key) & 0x7fffffffffffffff) % M; }
   bool contains(Key key) const { return search(key); }
-  auto search(Key key) const { return st[hash(key)].search(key); }
+  auto search(Key key) const { return bucket(key).search(key); }
+
+  bool rehashing() const { return old != nullptr; }
+
+  // an old bucket not yet migrated still owns its keys
+  SequentialSearchST<Key, Value> &bucket(Key key) const {
+    if (rehashing()) {
+      int i = (hashCode(key) & 0x7fffffffffffffff) % oldM;
+      if (i >= migrated) return old[i];
+    }
+    return st[hash(key)];
+  }
 
   void insert(Key key, Value val) {
-    if (!contains(key)) N++;
-    st[hash(key)].insert(key, val);
-    if (loadFactor() >= 10) resize(2 * M);
+    migrate();
+    if (bucket(key).insert(key, val)) N++;
+    if (!rehashing() && loadFactor() >= 10) resize(2 * M);
   }
 
   void remove(Key key) {
-    if (contains(key)) N--;
-    st[hash(key)].remove(key);
-    if (INIT_CAPACITY < M && loadFactor() <= 2) resize(M / 2);
+    migrate();
+    if (bucket(key).remove(key)) N--;
+    if (!rehashing() && INIT_CAPACITY < M && loadFactor() <= 2) resize(M / 2);
   }
 
   void resize(int x) {
+    if (rehashStep > 0) {
+      old = st;
+      oldM = M;
+      migrated = 0;
+      st = new SequentialSearchST<Key, Value>[x];
+      M = x;
+      return;
+    }
     auto next{new SequentialSearchST<Key, Value>[x]};
     for (int i = 0; i < M; i++) {
-      for (const auto &e : st[i]) next[hash(e.key)].insert(e.key, e.val);
+      for (const auto &e : st[i])
+        next[(hashCode(e.key) & 0x7fffffffffffffff) % x].insert(e.key, e.val);
     }
     delete[] st;
     st = next;
     M = x;
   }
 
+  // move up to rehashStep old buckets, relinking their nodes
+  void migrate() {
+    for (int k = 0; rehashing() && k < rehashStep; k++) {
+      for (auto x{old[migrated].release()}; x;) {
+        auto next{x->next};
+        st[hash(x->key)].link(x);
+        x = next;
+      }
+      if (++migrated == oldM) {
+        delete[] old;
+        old = nullptr;
+      }
+    }
+  }
+
   auto loadFactor() { return N / M; }
   int size() const { return N; }
   bool empty() const { return size() == 0; }
 };
 
+// open addressing with linear probing, one control byte per slot holding
+// 7 bits of the hash, compared a group of slots at a time
+// removal shifts the rest of the run back, so there are no tombstones and
+// a probe stops at the first empty slot
+template <class Key, class Value>
+  requires is_hashable<Key>
+struct FlatHashMap {
+#if defined(__AVX2__)
+  static constexpr int GROUP{32};
+#else
+  static constexpr int GROUP{16};
+#endif
+  static constexpr std::int8_t EMPTY{-128};
+  struct Slot {
+    Key key;
+    Value val;
+  };
+  int N, M;
+  std::hash<Key> hashCode;
+  // M + GROUP bytes, the tail mirrors the head so a group never wraps
+  std::int8_t *ctrl;
+  Slot *slots;
+
+  FlatHashMap() : FlatHashMap(GROUP) {}
+
+  FlatHashMap(int M)
+      : N{0},
+        M{std::max(GROUP, (int)std::bit_ceil((unsigned)M))},
+        hashCode{},
+        ctrl{new std::int8_t[this->M + GROUP]},
+        slots{(Slot *)operator new(this->M * sizeof(Slot))} {
+    std::fill(ctrl, ctrl + this->M + GROUP, EMPTY);
+  }
+
+  ~FlatHashMap() {
+    for (int i = 0; i < M; i++)
+      if (ctrl[i] != EMPTY) slots[i].~Slot();
+    operator delete(slots);
+    delete[] ctrl;
+  }
+
+  std::uint64_t hash(const Key &key) const {
+    std::uint64_t h{hashCode(key) * 0x9e3779b97f4a7c15ull};
+    return h ^ h >> 29;
+  }
+  int home(std::uint64_t h) const { return h & (M - 1); }
+  static std::int8_t tag(std::uint64_t h) { return h >> 57; }
+
+  // bit i set if ctrl[pos + i] == b
+  std::uint32_t match(int pos, std::int8_t b) const {
+#if defined(__AVX2__)
+    auto group{_mm256_loadu_si256((const __m256i *)(ctrl + pos))};
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(group, _mm256_set1_epi8(b)));
+#elif defined(__SSE2__)
+    auto group{_mm_loadu_si128((const __m128i *)(ctrl + pos))};
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(b)));
+#else
+    std::uint32_t mask{0};
+    for (int i = 0; i < GROUP; i++)
+      mask |= std::uint32_t{ctrl[pos + i] == b} << i;
+    return mask;
+#endif
+  }
+
+  void setCtrl(int i, std::int8_t b) {
+    ctrl[i] = b;
+    if (i < GROUP) ctrl[M + i] = b;
+  }
+
+  // slot holding key, or the empty slot ending its run
+  std::pair<int, bool> probe(const Key &key, std::uint64_t h) const {
+    for (int pos{home(h)};; pos = (pos + GROUP) & (M - 1)) {
+      std::uint32_t empty{match(pos, EMPTY)};
+      std::uint32_t candidates{match(pos, tag(h))};
+      // slots past the first empty belong to other runs
+      if (empty) candidates &= (empty & -empty) - 1;
+      for (; candidates; candidates &= candidates - 1) {
+        int i{(pos + std::countr_zero(candidates)) & (M - 1)};
+        if (slots[i].key == key) return {i, true};
+      }
+      if (empty) return {(pos + std::countr_zero(empty)) & (M - 1), false};
+    }
+  }
+
+  bool contains(const Key &key) const { return search(key); }
+  Slot *search(const Key &key) const {
+    auto [i, found]{probe(key, hash(key))};
+    return found ? slots + i : nullptr;
+  }
+
+  void insert(Key key, Value val) {
+    if (8 * (N + 1) > 7 * M) resize(2 * M);
+    std::uint64_t h{hash(key)};
+    auto [i, found]{probe(key, h)};
+    if (found) {
+      slots[i].val = std::move(val);
+      return;
+    }
+    new (slots + i) Slot{std::move(key), std::move(val)};
+    setCtrl(i, tag(h));
+    N++;
+  }
+
+  void remove(const Key &key) {
+    auto [i, found]{probe(key, hash(key))};
+    if (!found) return;
+    slots[i].~Slot();
+    int hole{i};
+    for (int j = (i + 1) & (M - 1); ctrl[j] != EMPTY; j = (j + 1) & (M - 1)) {
+      // j may fill the hole unless its home lies after the hole
+      int h{home(hash(slots[j].key))};
+      if (((j - h) & (M - 1)) < ((j - hole) & (M - 1))) continue;
+      new (slots + hole) Slot{std::move(slots[j])};
+      slots[j].~Slot();
+      setCtrl(hole, ctrl[j]);
+      hole = j;
+    }
+    setCtrl(hole, EMPTY);
+    N--;
+    if (GROUP < M && 8 * N <= M) resize(M / 2);
+  }
+
+  void resize(int x) {
+    std::int8_t *oldCtrl{ctrl};
+    Slot *oldSlots{slots};
+    int oldM{M};
+    M = x;
+    ctrl = new std::int8_t[M + GROUP];
+    slots = (Slot *)operator new(M * sizeof(Slot));
+    std::fill(ctrl, ctrl + M + GROUP, EMPTY);
+    for (int i = 0; i < oldM; i++) {
+      if (oldCtrl[i] == EMPTY) continue;
+      std::uint64_t h{hash(oldSlots[i].key)};
+      int j{home(h)};
+      while (ctrl[j] != EMPTY) j = (j + 1) & (M - 1);
+      new (slots + j) Slot{std::move(oldSlots[i])};
+      oldSlots[i].~Slot();
+      setCtrl(j, tag(h));
+    }
+    operator delete(oldSlots);
+    delete[] oldCtrl;
+  }
+
+  auto loadFactor() const { return (double)N / M; }
+  int size() const { return N; }
+  bool empty() const { return size() == 0; }
+};
+
+// striped locking: keys spread over SHARDS independent HashMaps, each
+// behind its own reader-writer lock, a shard grows or shrinks under its
+// own lock while the others stay available
+template <class Key, class Value, int SHARDS = 64>
+  requires is_hashable<Key> && (std::has_single_bit(unsigned{SHARDS}))
+struct ConcurrentHashMap {
+  struct alignas(64) Shard {
+    mutable std::shared_mutex rw;
+    HashMap<Key, Value> map;
+  };
+  std::hash<Key> hashCode;
+  Shard shards[SHARDS];
+
+  // rehashStep > 0 lets shards rehash incrementally
+  explicit ConcurrentHashMap(int rehashStep = 0) {
+    for (auto &x : shards) x.map.rehashStep = rehashStep;
+  }
+
+  // high bits pick the shard, HashMap buckets by the low bits
+  Shard &shard(const Key &key) {
+    std::uint64_t h{hashCode(key) * 0x9e3779b97f4a7c15ull};
+    return shards[h >> 40 & (SHARDS - 1)];
+  }
+  const Shard &shard(const Key &key) const {
+    return const_cast<ConcurrentHashMap *>(this)->shard(key);
+  }
+
+  std::optional<Value> search(const Key &key) const {
+    const Shard &x{shard(key)};
+    std::shared_lock lk(x.rw);
+    if (auto node{x.map.search(key)}) return node->val;
+    return std::nullopt;
+  }
+
+  bool contains(const Key &key) const {
+    const Shard &x{shard(key)};
+    std::shared_lock lk(x.rw);
+    return x.map.contains(key);
+  }
+
+  void insert(const Key &key, const Value &val) {
+    Shard &x{shard(key)};
+    std::unique_lock lk(x.rw);
+    x.map.insert(key, val);
+  }
+
+  void remove(const Key &key) {
+    Shard &x{shard(key)};
+    std::unique_lock lk(x.rw);
+    x.map.remove(key);
+  }
+
+  // val if key is absent, merge(current, val) otherwise
+  template <class Merge>
+  void upsert(const Key &key, const Value &val, Merge merge) {
+    Shard &x{shard(key)};
+    std::unique_lock lk(x.rw);
+    if (auto node{x.map.search(key)})
+      node->val = merge(node->val, val);
+    else
+      x.map.insert(key, val);
+  }
+
+  // exact only while no writer is running
+  int size() const {
+    int n{0};
+    for (const auto &x : shards) {
+      std::shared_lock lk(x.rw);
+      n += x.map.size();
+    }
+    return n;
+  }
+  bool empty() const { return size() == 0; }
+};
+
 int main() {
   std::mt19937 mt(std::random_device{}());
   std::uniform_int_distribution rand(100, 999);
@@ -150,4 +449,62 @@ int main() {
     if (HashMap.search(e)) HashMap.remove(e);
     std::print("\n");
   }
+
+  // random operations against the chained map, keys collide often
+  std::uniform_int_distribution key(0, 4095), op(0, 2);
+  ::HashMap<int, int> chained, incremental(4, 1);
+  FlatHashMap<int, int> flat;
+  int rehashed{0};
+  for (int i = 0; i < 1 << 16; i++) {
+    int k{key(mt)};
+    switch (op(mt)) {
+      case 0:
+        chained.insert(k, i), flat.insert(k, i), incremental.insert(k, i);
+        break;
+      case 1:
+        chained.remove(k), flat.remove(k), incremental.remove(k);
+        break;
+      case 2:
+        assert(chained.contains(k) == flat.contains(k));
+        assert(chained.contains(k) == incremental.contains(k));
+        if (auto x{flat.search(k)}) {
+          assert(chained.search(k)->val == x->val);
+          assert(incremental.search(k)->val == x->val);
+        }
+        break;
+    }
+    rehashed += incremental.rehashing();
+    assert(chained.size() == flat.size());
+    assert(chained.size() == incremental.size());
+  }
+  assert(rehashed > 0);
+  for (int k = 0; k < 4096; k++) flat.remove(k);
+  assert(flat.empty() && flat.M == flat.GROUP);
+
+  // writers count into shared keys while readers probe them
+  constexpr int threads{8}, rounds{1 << 12}, keys{256};
+  ConcurrentHashMap<int, int> counter(2);
+  {
+    std::vector<std::jthread> pool;
+    for (int t = 0; t < threads; t++) {
+      pool.emplace_back([&counter, t] {
+        for (int i = 0; i < rounds; i++) {
+          counter.upsert(i % keys, 1, std::plus<int>{});
+          counter.insert(keys + t * rounds + i, i);
+        }
+        for (int i = 0; i < rounds; i += 2)
+          counter.remove(keys + t * rounds + i);
+      });
+      pool.emplace_back([&counter] {
+        for (int i = 0; i < rounds; i++)
+          if (auto x{counter.search(i % keys)}) assert(0 < *x);
+      });
+    }
+  }
+  assert(counter.size() == keys + threads * rounds / 2);
+  for (int k = 0; k < keys; k++)
+    assert(*counter.search(k) == threads * rounds / keys);
+  for (int t = 0; t < threads; t++)
+    for (int i = 0; i < rounds; i++)
+      assert(counter.contains(keys + t * rounds + i) == (i % 2 == 1));
 }
\ No newline at end of file
@@ -1,7 +1,13 @@
 #include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
 #include <concepts>
+#include <cstddef>
 #include <print>
 #include <random>
+#include <span>
+#include <vector>
 
 #include "vector.hh"
 
@@ -36,6 +42,258 @@ struct QuickSelect {
   }
 };
 
+// in place on the caller's span: A[k] ends up as the k-th smallest with
+// nothing larger before it and nothing smaller after it
+// Floyd-Rivest narrows the range to a sample bracketing k before each
+// partition, and a range that keeps failing to shrink falls back to
+// median of medians, linear in the worst case
+template <typename compar>
+  requires std::totally_ordered<compar>
+struct FloydRivest {
+  static constexpr std::ptrdiff_t SAMPLE{600};
+
+  static compar &select(std::span<compar> A, std::size_t k) {
+    assert(k < A.size());
+    select(A, 0, A.size() - 1, k);
+    return A[k];
+  }
+
+  static void select(std::span<compar> A, std::ptrdiff_t lo,
+                     std::ptrdiff_t hi, std::ptrdiff_t k) {
+    int bad{0};
+    while (lo < hi) {
+      std::ptrdiff_t size{hi - lo + 1};
+      if (size > SAMPLE) {
+        double n = size, i = k - lo + 1, z{std::log(n)};
+        double s{0.5 * std::exp(2 * z / 3)};
+        double sd{0.5 * std::sqrt(z * s * (n - s) / n) * (i < n / 2 ? -1 : 1)};
+        std::ptrdiff_t l = std::max<double>(lo, k - i * s / n + sd);
+        std::ptrdiff_t r = std::min<double>(hi, k + (n - i) * s / n + sd);
+        select(A, l, r, k);
+      }
+      // Hoare partition around t = A[k], stops on equal keys
+      compar t{A[k]};
+      std::ptrdiff_t i{lo}, j{hi};
+      std::swap(A[lo], A[k]);
+      if (t < A[hi]) std::swap(A[hi], A[lo]);
+      while (i < j) {
+        std::swap(A[i++], A[j--]);
+        while (A[i] < t) i++;
+        while (t < A[j]) j--;
+      }
+      if (A[lo] == t)
+        std::swap(A[lo], A[j]);
+      else
+        std::swap(A[++j], A[hi]);
+      if (j <= k) lo = j + 1;
+      if (k <= j) hi = j - 1;
+
+      if (4 * (hi - lo + 1) > 3 * size && ++bad > 2) {
+        medianOfMedians(A, lo, hi, k);
+        return;
+      }
+    }
+  }
+
+  // BFPRT, the pivot is the median of the medians of groups of 5
+  static void medianOfMedians(std::span<compar> A, std::ptrdiff_t lo,
+                              std::ptrdiff_t hi, std::ptrdiff_t k) {
+    while (hi - lo + 1 > 5) {
+      std::ptrdiff_t m{lo};
+      for (std::ptrdiff_t g = lo; g <= hi; g += 5) {
+        std::ptrdiff_t e{std::min(g + 4, hi)};
+        insertion(A, g, e);
+        std::swap(A[m++], A[g + (e - g) / 2]);
+      }
+      medianOfMedians(A, lo, m - 1, lo + (m - lo - 1) / 2);
+      auto [lt, gt] = partition3(A, lo, hi, A[lo + (m - lo - 1) / 2]);
+      if (k < lt)
+        hi = lt - 1;
+      else if (gt < k)
+        lo = gt + 1;
+      else
+        return;
+    }
+    insertion(A, lo, hi);
+  }
+
+  static void insertion(std::span<compar> A, std::ptrdiff_t lo,
+                        std::ptrdiff_t hi) {
+    for (std::ptrdiff_t i = lo + 1; i <= hi; ++i)
+      for (std::ptrdiff_t j = i; j > lo && A[j] < A[j - 1]; --j)
+        std::swap(A[j], A[j - 1]);
+  }
+
+  // A[lt..gt] equal to the pivot
+  static std::pair<std::ptrdiff_t, std::ptrdiff_t> partition3(
+      std::span<compar> A, std::ptrdiff_t lo, std::ptrdiff_t hi,
+      compar pivot) {
+    std::ptrdiff_t lt{lo}, gt{hi}, i{lo};
+    while (i <= gt)
+      if (A[i] < pivot)
+        std::swap(A[lt++], A[i++]);
+      else if (pivot < A[i])
+        std::swap(A[i], A[gt--]);
+      else
+        ++i;
+    return {lt, gt};
+  }
+
+  // the order statistics of every rank in one recursive pass: the middle
+  // rank splits A, the ranks below it are searched on its left only
+  static ns::vector<compar> select(std::span<compar> A,
+                                   std::span<const std::size_t> ranks) {
+    std::vector<std::size_t> sorted(ranks.begin(), ranks.end());
+    std::ranges::sort(sorted);
+    if (!A.empty()) multiselect(A, 0, A.size() - 1, sorted);
+    ns::vector<compar> result;
+    result.reserve(ranks.size());
+    for (auto k : ranks) result.push_back(A[k]);
+    return result;
+  }
+
+  static void multiselect(std::span<compar> A, std::ptrdiff_t lo,
+                          std::ptrdiff_t hi, std::span<std::size_t> ranks) {
+    while (!ranks.empty() && lo < hi) {
+      std::size_t mid{ranks.size() / 2};
+      std::ptrdiff_t k = ranks[mid];
+      assert(lo <= k && k <= hi);
+      select(A, lo, hi, k);
+      // duplicates of k are answered already
+      auto below{std::ranges::lower_bound(ranks, ranks[mid])};
+      auto above{std::ranges::upper_bound(ranks, ranks[mid])};
+      multiselect(A, lo, k - 1, {ranks.begin(), below});
+      ranks = {above, ranks.end()};
+      lo = k + 1;
+    }
+  }
+
+  // nearest-rank percentiles, p in [0, 1]
+  static ns::vector<compar> percentiles(std::span<compar> A,
+                                        std::span<const double> ps) {
+    assert(!A.empty());
+    std::vector<std::size_t> ranks;
+    for (double p : ps) {
+      assert(0 <= p && p <= 1);
+      ranks.push_back(std::llround(p * (A.size() - 1)));
+    }
+    return select(A, ranks);
+  }
+};
+
+// KLL sketch (Karnin, Lang & Liberty), compactor h holds items of weight
+// 2^h; a full compactor is sorted and every other item, from a random
+// offset, is promoted to the next one. Capacities shrink by C going down
+// from the top, so memory stays O(k) and the rank error O(n / k)
+template <typename compar>
+  requires std::totally_ordered<compar>
+struct KLLSketch {
+  static constexpr double C{2.0 / 3};
+  int k;
+  long long n{0};
+  std::vector<std::vector<compar>> compactors;
+  std::mt19937 mt;
+
+  explicit KLLSketch(int k = 200)
+      : k{k}, compactors(1), mt(std::random_device{}()) {
+    assert(k >= 8);
+  }
+
+  int capacity(int h) const {
+    int depth = compactors.size() - h - 1;
+    return std::max(2, (int)std::ceil(k * std::pow(C, depth)));
+  }
+
+  int size() const {
+    int items{0};
+    for (const auto &c : compactors) items += c.size();
+    return items;
+  }
+
+  int maxSize() const {
+    int items{0};
+    for (int h = 0; h < (int)compactors.size(); h++) items += capacity(h);
+    return items;
+  }
+
+  void insert(const compar &x) {
+    compactors[0].push_back(x);
+    n++;
+    if ((int)compactors[0].size() >= capacity(0)) compress();
+  }
+
+  void insert(std::span<const compar> batch) {
+    for (const auto &x : batch) {
+      compactors[0].push_back(x);
+      n++;
+      if ((int)compactors[0].size() >= capacity(0)) compress();
+    }
+  }
+
+  void merge(const KLLSketch &other) {
+    if (compactors.size() < other.compactors.size())
+      compactors.resize(other.compactors.size());
+    for (int h = 0; h < (int)other.compactors.size(); h++)
+      compactors[h].insert(compactors[h].end(), other.compactors[h].begin(),
+                           other.compactors[h].end());
+    n += other.n;
+    compress();
+  }
+
+  // compacts full compactors from the bottom up, each compaction feeds the
+  // level above, so every level ends below its capacity
+  void compress() {
+    for (int h = 0; h < (int)compactors.size(); h++) {
+      if ((int)compactors[h].size() < capacity(h)) continue;
+      if (h + 1 == (int)compactors.size()) compactors.emplace_back();
+      auto &from{compactors[h]};
+      auto &to{compactors[h + 1]};
+      std::ranges::sort(from);
+      // an odd item out stays behind
+      int pairs = from.size() / 2 * 2;
+      for (int i = mt() & 1; i < pairs; i += 2) to.push_back(from[i]);
+      from.erase(from.begin(), from.begin() + pairs);
+    }
+  }
+
+  // the items and their weights in ascending order
+  std::vector<std::pair<compar, long long>> weighted() const {
+    std::vector<std::pair<compar, long long>> items;
+    for (int h = 0; h < (int)compactors.size(); h++)
+      for (const auto &x : compactors[h]) items.push_back({x, 1LL << h});
+    std::ranges::sort(items, {}, &std::pair<compar, long long>::first);
+    return items;
+  }
+
+  // estimated count of items <= x
+  long long rank(const compar &x) const {
+    long long r{0};
+    for (int h = 0; h < (int)compactors.size(); h++)
+      for (const auto &y : compactors[h])
+        if (y <= x) r += 1LL << h;
+    return r;
+  }
+
+  compar quantile(double q) const {
+    return quantiles(std::span<const double>(&q, 1))[0];
+  }
+
+  // one sort for many quantiles, q in [0, 1]
+  ns::vector<compar> quantiles(std::span<const double> qs) const {
+    assert(n > 0);
+    auto items{weighted()};
+    ns::vector<compar> result;
+    for (double q : qs) {
+      assert(0 <= q && q <= 1);
+      long long target = q * (n - 1), seen{0};
+      auto it{items.begin()};
+      while (it + 1 != items.end() && (seen += it->second) <= target) ++it;
+      result.push_back(it->first);
+    }
+    return result;
+  }
+};
+
 int main() {
   std::mt19937 mt(std::random_device{}());
   std::uniform_int_distribution rand(10, 99);
@@ -53,4 +311,83 @@ int main() {
   for (int i = 0; i < 12; ++i)
     std::print("{}\t", QuickSelect<int>::select(a, i));
   std::print("\n");
-}
\ No newline at end of file
+
+  // against a sorted copy, keys drawn from small and large ranges
+  for (int n : {1, 7, 100, 601, 5000, 1 << 18})
+    for (int range : {4, 1 << 30}) {
+      std::uniform_int_distribution randKey(0, range);
+      std::vector<int> B(n);
+      for (auto &e : B) e = randKey(mt);
+      auto sorted{B};
+      std::ranges::sort(sorted);
+      for (std::size_t k : {0, n / 3, n / 2, n - 1}) {
+        auto C{B};
+        assert(FloydRivest<int>::select(C, k) == sorted[k]);
+        assert(std::all_of(C.begin(), C.begin() + k,
+                           [&](int x) { return x <= C[k]; }));
+        assert(std::all_of(C.begin() + k, C.end(),
+                           [&](int x) { return x >= C[k]; }));
+        C = B;
+        FloydRivest<int>::medianOfMedians(C, 0, n - 1, k);
+        assert(C[k] == sorted[k]);
+      }
+      std::vector<std::size_t> ranks;
+      for (int i = 0; i < 64; i++) ranks.push_back(mt() % n);
+      ranks.push_back(ranks.front());
+      auto C{B};
+      auto values{FloydRivest<int>::select(std::span(C), ranks)};
+      for (std::size_t i = 0; i < ranks.size(); i++)
+        assert(values[i] == sorted[ranks[i]]);
+    }
+
+  std::vector<int> latency(1 << 20);
+  std::exponential_distribution<> randLatency(0.01);
+  for (auto &e : latency) e = randLatency(mt);
+  double ps[]{0.5, 0.9, 0.99};
+  auto p{FloydRivest<int>::percentiles(latency, ps)};
+  std::print("p50 {}\tp90 {}\tp99 {}\n", p[0], p[1], p[2]);
+  assert(p[0] <= p[1] && p[1] <= p[2]);
+
+  // inserts alone must keep every compactor within its capacity
+  {
+    KLLSketch<int> sketch(200);
+    for (int i = 0; i < 1000000; i++) sketch.insert(mt());
+    assert(sketch.size() <= sketch.maxSize());
+  }
+
+  // per-thread sketches merged, ranks checked against QuickSelect
+  constexpr int K{200}, threads{4};
+  double qs[]{0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99};
+  std::normal_distribution<> randNormal(0, 1000);
+  for (int stream = 0; stream < 3; stream++) {
+    int n{200000};
+    ns::vector<int> data(n);
+    for (int i = 0; i < n; i++)
+      data[i] = stream == 0   ? mt() % 1000000
+                : stream == 1 ? (int)randNormal(mt)
+                              : i;
+    KLLSketch<int> sketch(K);
+    // built one by one, a fill copy would share one coin flip sequence
+    std::vector<KLLSketch<int>> local;
+    for (int t = 0; t < threads; t++) local.emplace_back(K);
+    for (int t = 0; t < threads; t++)
+      local[t].insert(std::span<const int>(data.begin() + n / threads * t,
+                                           n / threads));
+    for (const auto &l : local) sketch.merge(l);
+    assert(sketch.n == n && sketch.size() <= sketch.maxSize());
+    assert(sketch.size() < 4 * K);
+
+    auto estimates{sketch.quantiles(qs)};
+    for (int i = 0; i < (int)std::size(qs); i++) {
+      int k = qs[i] * (n - 1);
+      int exact{QuickSelect<int>::select(data, k)};
+      // where the estimate actually ranks in the data
+      int below{0}, atMost{0};
+      for (int x : data) below += x < estimates[i], atMost += x <= estimates[i];
+      int error{std::max({0, below - k, k - atMost})};
+      std::print("q {}\texact {}\testimate {}\trank error {:.4f}\n", qs[i],
+                 exact, estimates[i], (double)error / n);
+      assert(error <= 0.02 * n);
+    }
+  }
+}
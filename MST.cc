@@ -23,19 +23,23 @@ struct KruskalMST {
 };
 
 // priority first search minimun spanning forest
+// Queue: IndexMinPQ or DaryIndexMinPQ, keys are not monotone here
+template <class Queue = IndexMinPQ<int>>
 struct PrimMST {
   ns::deque<Edge *> edgeTo;
   ns::deque<int> distTo;
   ns::deque<bool> marked;
-  IndexMinPQ<int> pq;
+  Queue pq;
 
-  PrimMST(const EdgeWeightedGraph &G)
+  template <isAdjacency Adj>
+  PrimMST(const Adj &G)
       : edgeTo(G.V, nullptr), distTo(G.V, 0xffff), marked(G.V, false), pq(G.V) {
     for (int v = 0; v < G.V; ++v)
       if (!marked[v]) search(G, v);
   }
 
-  void search(const EdgeWeightedGraph &G, int s) {
+  template <isAdjacency Adj>
+  void search(const Adj &G, int s) {
     distTo[s] = 0;
     pq.insert(s, distTo[s]);
     while (!pq.empty()) {
@@ -44,7 +48,8 @@ struct PrimMST {
     }
   }
 
-  void scan(const EdgeWeightedGraph &G, int v) {
+  template <isAdjacency Adj>
+  void scan(const Adj &G, int v) {
     marked[v] = true;
     for (const auto &e : G.adj[v]) {
       int w{e.other(v)};
@@ -139,6 +144,13 @@ int main() {
     std::print("\n");
     assert(KMST.weight() == PMST.weight());
 
+    PrimMST CSRMST(CSRGraph<Edge>{EWG});
+    assert(CSRMST.weight() == PMST.weight());
+    PrimMST<DaryIndexMinPQ<int, 2>> BinaryMST(EWG);
+    assert(BinaryMST.weight() == PMST.weight());
+    PrimMST<DaryIndexMinPQ<int, 8>> OctalMST(EWG);
+    assert(OctalMST.weight() == PMST.weight());
+
     std::print("LazyPrimMST\n");
     LazyPrimMST LPMST(EWG);
     printMST(LPMST);
@@ -1,6 +1,11 @@
 #pragma once
+#include <bit>
 #include <cassert>
 #include <concepts>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "deque.hh"
 
@@ -171,6 +176,203 @@ struct IndexMinPQ {
   }
 };
 
+/**
+ *          k
+ *      /  ...  \
+ *   dk+1  ...  dk+d
+ */
+
+// d-ary heap holding (key, index) pairs, no keys[pq[k]] indirection, the d
+// siblings of a node start at a cache line boundary
+template <typename T, int D = 4>
+  requires std::totally_ordered<T> && std::is_trivially_copyable_v<T>
+struct DaryIndexMinPQ {
+  struct Entry {
+    T key;
+    int i;
+  };
+  static constexpr std::align_val_t LINE{64};
+  Entry *base;
+  Entry *pq;
+  int *qp;
+  int maxN;
+  int n;
+
+  DaryIndexMinPQ(int maxN)
+      : base{(Entry *)operator new((maxN + D) * sizeof(Entry), LINE)},
+        pq{base + D - 1},
+        qp{new int[maxN + 1]},
+        maxN{maxN},
+        n{0} {
+    for (int i = 0; i <= maxN; i++) qp[i] = -1;
+  }
+
+  ~DaryIndexMinPQ() {
+    operator delete(base, LINE);
+    delete[] qp;
+  }
+
+  bool empty() const { return n == 0; }
+  bool contains(int i) const { return qp[i] != -1; }
+
+  void insert(int i, T key) {
+    assert(n < maxN && !contains(i));
+    pq[n] = {key, i};
+    qp[i] = n;
+    swim(n++);
+  }
+
+  int delMin() {
+    assert(n > 0);
+    int min{pq[0].i};
+    qp[min] = -1;
+    if (--n > 0) {
+      pq[0] = pq[n];
+      qp[pq[0].i] = 0;
+      sink(0);
+    }
+    return min;
+  }
+
+  void decreaseKey(int i, T key) {
+    pq[qp[i]].key = key;
+    swim(qp[i]);
+  }
+
+  void increaseKey(int i, T key) {
+    pq[qp[i]].key = key;
+    sink(qp[i]);
+  }
+
+  // move the hole instead of swapping
+  void swim(int k) {
+    Entry x{pq[k]};
+    while (k > 0) {
+      int parent{(k - 1) / D};
+      if (!(x.key < pq[parent].key)) break;
+      pq[k] = pq[parent];
+      qp[pq[k].i] = k;
+      k = parent;
+    }
+    pq[k] = x;
+    qp[x.i] = k;
+  }
+
+  void sink(int k) {
+    Entry x{pq[k]};
+    while (D * k + 1 < n) {
+      int first{D * k + 1}, last{std::min(first + D, n)}, j{first};
+      for (int c = first + 1; c < last; c++)
+        if (pq[c].key < pq[j].key) j = c;
+      if (!(pq[j].key < x.key)) break;
+      pq[k] = pq[j];
+      qp[pq[k].i] = k;
+      k = j;
+    }
+    pq[k] = x;
+    qp[x.i] = k;
+  }
+
+  bool isMinHeap() const {
+    for (int k = 1; k < n; k++)
+      if (pq[k].key < pq[(k - 1) / D].key) return false;
+    return true;
+  }
+};
+
+// monotone radix heap, keys never drop below the last key removed
+// bucket b holds keys whose highest bit differing from last is bit b-1, so
+// an entry only moves to lower buckets, at most once per bit
+// decreaseKey pushes a new entry and leaves the old one to be skipped
+template <typename T>
+  requires std::integral<T>
+struct RadixIndexMinPQ {
+  using U = std::make_unsigned_t<T>;
+  static constexpr int B{sizeof(T) * 8 + 1};
+  std::vector<std::pair<T, int>> bucket[B];
+  T *keys;
+  bool *in;
+  int maxN;
+  int n;
+  T last;
+
+  RadixIndexMinPQ(int maxN)
+      : keys{new T[maxN + 1]},
+        in{new bool[maxN + 1]{}},
+        maxN{maxN},
+        n{0},
+        last{0} {}
+
+  ~RadixIndexMinPQ() {
+    delete[] keys;
+    delete[] in;
+  }
+
+  bool empty() const { return n == 0; }
+  bool contains(int i) const { return in[i]; }
+
+  void insert(int i, T key) {
+    assert(n < maxN && !contains(i));
+    in[i] = true;
+    n++;
+    push(i, key);
+  }
+
+  int delMin() {
+    assert(n > 0);
+    while (true) {
+      if (bucket[0].empty()) refill();
+      auto [key, i]{bucket[0].back()};
+      bucket[0].pop_back();
+      if (in[i] && keys[i] == key) {
+        in[i] = false;
+        n--;
+        return i;
+      }
+    }
+  }
+
+  void decreaseKey(int i, T key) {
+    assert(contains(i) && key <= keys[i]);
+    push(i, key);
+  }
+
+  void increaseKey(int i, T key) {
+    assert(contains(i) && key >= keys[i]);
+    push(i, key);
+  }
+
+  void push(int i, T key) {
+    assert(key >= last);
+    keys[i] = key;
+    bucket[index(key)].emplace_back(key, i);
+  }
+
+  int index(T key) const {
+    return key == last ? 0 : std::bit_width(U(key) ^ U(last));
+  }
+
+  // the smallest live key becomes last, its bucket scatters downwards
+  void refill() {
+    for (int b = 1; b < B; b++) {
+      auto &from{bucket[b]};
+      bool found{false};
+      for (const auto &[key, i] : from)
+        if (in[i] && keys[i] == key && (!found || key < last)) {
+          last = key;
+          found = true;
+        }
+      if (found) {
+        for (const auto &[key, i] : from)
+          if (in[i] && keys[i] == key) bucket[index(key)].emplace_back(key, i);
+        from.clear();
+        return;
+      }
+      from.clear();
+    }
+  }
+};
+
 template <class T, class Comparator>
 struct PQ {
   T *pq;
@@ -6,7 +6,8 @@ struct KosarajuSCC {
   ns::deque<int> id;
   int count;
 
-  KosarajuSCC(const Digraph &G) : marked(G.V, false), id(G.V), count{0} {
+  template <isAdjacency Adj>
+  KosarajuSCC(const Adj &G) : marked(G.V, false), id(G.V), count{0} {
     DepthFirstOrder DFS(G.reverse());
     for (int v : DFS.reversePost())
       if (!marked[v]) {
@@ -15,7 +16,8 @@ struct KosarajuSCC {
       }
   }
 
-  void dfs(const Digraph &G, int v) {
+  template <isAdjacency Adj>
+  void dfs(const Adj &G, int v) {
     marked[v] = true;
     id[v] = count;
     for (int w : G.adj[v]) {
@@ -31,12 +33,14 @@ struct TarjanSCC {
   ns::deque<int> id, low, stack;
   int clock{0}, count{0};
 
-  TarjanSCC(const Digraph &G) : marked(G.V, false), id(G.V), low(G.V) {
+  template <isAdjacency Adj>
+  TarjanSCC(const Adj &G) : marked(G.V, false), id(G.V), low(G.V) {
     for (int v = 0; v < G.V; v++)
       if (!marked[v]) dfs(G, v);
   }
 
-  void dfs(const Digraph &G, int v) {
+  template <isAdjacency Adj>
+  void dfs(const Adj &G, int v) {
     marked[v] = true;
     low[v] = ++clock;
     int min = low[v];
@@ -96,5 +100,13 @@ int main() {
     for (int v = 0; v < G.V; v++)
       for (int w = v; w < G.V; w++)
         assert(tscc.connected(v, w) == kscc.connected(v, w));
+
+    CSRGraph<int> CSR(DG);
+    KosarajuSCC kcsr(CSR);
+    TarjanSCC tcsr(CSR);
+    for (int v = 0; v < G.V; v++) {
+      assert(kcsr.id[v] == kscc.id[v]);
+      assert(tcsr.id[v] == tscc.id[v]);
+    }
   }
 }
\ No newline at end of file
@@ -0,0 +1,52 @@
+// make SPDeltaBench CXXFLAGS="-std=c++23 -O2 -DNDEBUG"
+// IndexMinPQ asserts the heap invariant on every operation, so time with
+// NDEBUG; usage: SPDeltaBench.exe [V] [out degree] [delta]
+#include <chrono>
+
+#include "SPDeltaStepping.hh"
+#include "SPDikstra.hh"
+
+template <class F>
+double millis(F &&f) {
+  auto start{std::chrono::steady_clock::now()};
+  f();
+  std::chrono::duration<double, std::milli> elapsed{
+      std::chrono::steady_clock::now() - start};
+  return elapsed.count();
+}
+
+int main(int argc, char *argv[]) {
+  int v{argc > 1 ? std::atoi(argv[1]) : 1 << 20};
+  int degree{argc > 2 ? std::atoi(argv[2]) : 8};
+  int delta{argc > 3 ? std::atoi(argv[3]) : 4};
+
+  // random multigraph, generateGraph is quadratic in the edge count
+  std::mt19937 mt(std::random_device{}());
+  std::uniform_int_distribution randV(0, v - 1), randE(0, 7);
+  EdgeWeightedDigraph EWD(v);
+  for (int i = 0; i < degree * v; ++i)
+    EWD.addEdge({randV(mt), randV(mt), randE(mt)});
+  CSRGraph<DirectedEdge> G(EWD);
+  std::print("V {}\tE {}\tdelta {}\n", G.V, G.E, delta);
+
+  ns::deque<int> expected;
+  double base{millis([&] { expected = DikstraSP(G, 0).distTo; })};
+  std::print("DikstraSP\t\t{:.1f} ms\t{:.1f} MTEPS\n", base, G.E / base / 1e3);
+  double dary{millis([&] { DikstraSP<DaryIndexMinPQ<int, 4>>(G, 0); })};
+  std::print("DikstraSP 4-ary\t\t{:.1f} ms\t{:.1f} MTEPS\n", dary,
+             G.E / dary / 1e3);
+  double radix{millis([&] { DikstraSP<RadixIndexMinPQ<int>>(G, 0); })};
+  std::print("DikstraSP radix\t\t{:.1f} ms\t{:.1f} MTEPS\n", radix,
+             G.E / radix / 1e3);
+
+  int cores{DeltaSteppingSP::concurrency()};
+  for (int threads = 1; threads <= 2 * cores; threads *= 2) {
+    ns::deque<int> distTo;
+    double ms{millis(
+        [&] { distTo = DeltaSteppingSP(G, 0, delta, threads).distTo; })};
+    assert(std::equal(distTo.begin(), distTo.end(), expected.begin(),
+                      expected.end()));
+    std::print("DeltaSteppingSP x{}\t{:.1f} ms\t{:.1f} MTEPS\t{:.2f}x\n",
+               threads, ms, G.E / ms / 1e3, base / ms);
+  }
+}
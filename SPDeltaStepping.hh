@@ -0,0 +1,154 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "Graph.hh"
+
+// delta-stepping (Meyer & Sanders)
+// bucket i holds vertices with distTo in [i*delta, (i+1)*delta), light edges
+// (weight <= delta) are relaxed until bucket i stops refilling, then the
+// heavy edges of every vertex settled in bucket i are relaxed once
+struct DeltaSteppingSP {
+  ns::deque<int> distTo;
+  ns::deque<DirectedEdge *> edgeTo;
+
+  static int concurrency() {
+    return std::max(1, (int)std::thread::hardware_concurrency());
+  }
+
+  template <isAdjacency Adj>
+  DeltaSteppingSP(const Adj &G, int s, int delta = 4,
+                  int threads = concurrency())
+      : distTo(G.V, 0xffff), edgeTo(G.V, nullptr) {
+    assert(0 <= s && s < G.V);
+    assert(delta > 0 && threads > 0);
+    search(G, s, delta, threads);
+  }
+
+  // distance in the high half, predecessor in the low half, so that both
+  // change under one compare-and-swap
+  static std::uint64_t pack(int dist, int pred) {
+    return (std::uint64_t)dist << 32 | (std::uint32_t)pred;
+  }
+  static int dist(std::uint64_t x) { return x >> 32; }
+  static int pred(std::uint64_t x) { return (int)(std::uint32_t)x; }
+
+  template <isAdjacency Adj>
+  void search(const Adj &G, int s, int delta, int threads) {
+    constexpr auto relaxed{std::memory_order_relaxed};
+    int V{G.V};
+    std::vector<std::atomic<std::uint64_t>> label(V);
+    for (auto &x : label) x.store(pack(0xffff, -1), relaxed);
+    label[s].store(pack(0, -1), relaxed);
+    std::vector<std::atomic<bool>> settled(V);
+
+    // buckets are kept per thread and gathered into frontier between phases
+    std::vector<std::vector<std::vector<int>>> bins(threads);
+    std::vector<std::vector<int>> reached(threads);
+    std::vector<int> frontier{s};
+    int bucket{0};
+    bool heavy{false}, done{false};
+
+    auto relax = [&](int t, int v, int dv, const DirectedEdge &e) {
+      int w{e.to}, dw{dv + e.weight};
+      auto x{label[w].load(relaxed)};
+      while (dw < dist(x))
+        if (label[w].compare_exchange_weak(x, pack(dw, v), relaxed)) {
+          auto &local{bins[t]};
+          if ((int)local.size() <= dw / delta) local.resize(dw / delta + 1);
+          local[dw / delta].push_back(w);
+          break;
+        }
+    };
+
+    auto gather = [&](int i) {
+      frontier.clear();
+      for (auto &local : bins)
+        if (i < (int)local.size()) {
+          frontier.insert(frontier.end(), local[i].begin(), local[i].end());
+          local[i].clear();
+        }
+    };
+
+    // runs on one thread once every worker finished the phase
+    auto phase = [&]() noexcept {
+      if (!heavy) {
+        gather(bucket);
+        if (frontier.empty()) heavy = true;
+        return;
+      }
+      heavy = false;
+      int next{0x7fffffff};
+      for (const auto &local : bins)
+        for (int i = bucket + 1; i < std::min(next, (int)local.size()); i++)
+          if (!local[i].empty()) {
+            next = i;
+            break;
+          }
+      if (next == 0x7fffffff) {
+        done = true;
+        return;
+      }
+      bucket = next;
+      gather(bucket);
+    };
+    std::barrier sync(threads, phase);
+
+    auto worker = [&](int t) {
+      while (!done) {
+        if (heavy) {
+          for (int v : reached[t]) {
+            int dv{dist(label[v].load(relaxed))};
+            for (const auto &e : G.adj[v])
+              if (e.weight > delta) relax(t, v, dv, e);
+            settled[v].store(false, relaxed);
+          }
+          reached[t].clear();
+        } else {
+          long long n = frontier.size();
+          for (int i = n * t / threads; i < n * (t + 1) / threads; i++) {
+            int v{frontier[i]}, dv{dist(label[v].load(relaxed))};
+            // stale entry, v moved to a lower bucket since it was queued
+            if (dv / delta != bucket) continue;
+            if (!settled[v].exchange(true, relaxed)) reached[t].push_back(v);
+            for (const auto &e : G.adj[v])
+              if (e.weight <= delta) relax(t, v, dv, e);
+          }
+        }
+        sync.arrive_and_wait();
+      }
+    };
+    {
+      std::vector<std::jthread> pool;
+      for (int t = 1; t < threads; t++) pool.emplace_back(worker, t);
+      worker(0);
+    }
+
+    for (int w = 0; w < V; w++) distTo[w] = dist(label[w].load(relaxed));
+    for (int w = 0; w < V; w++) {
+      int v{pred(label[w].load(relaxed))};
+      if (v == -1) continue;
+      for (const auto &e : G.adj[v])
+        if (e.to == w && distTo[v] + e.weight == distTo[w]) {
+          edgeTo[w] = new DirectedEdge(e);
+          break;
+        }
+    }
+  }
+
+  ~DeltaSteppingSP() {
+    for (auto e : edgeTo) delete e;
+  }
+
+  bool hasPathTo(int v) const { return distTo[v] < 0xffff; }
+
+  auto pathTo(int v) const {
+    ns::deque<DirectedEdge> path;
+    for (auto e{edgeTo[v]}; e; e = edgeTo[e->from]) path.push_front(*e);
+    return path;
+  }
+};
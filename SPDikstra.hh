@@ -1,12 +1,15 @@
 #include "Graph.hh"
 #include "PQ.hh"
 
+// Queue: IndexMinPQ, DaryIndexMinPQ or RadixIndexMinPQ
+template <class Queue = IndexMinPQ<int>>
 struct DikstraSP {
   ns::deque<int> distTo;
   ns::deque<DirectedEdge *> edgeTo;
-  IndexMinPQ<int> pq;
+  Queue pq;
 
-  DikstraSP(const EdgeWeightedDigraph &G, int s)
+  template <isAdjacency Adj>
+  DikstraSP(const Adj &G, int s)
       : distTo(G.V, 0xffff), edgeTo(G.V, nullptr), pq(G.V) {
     assert(0 <= s && s < G.V);
     distTo[s] = 0;
@@ -1,5 +1,6 @@
 #include "SPAcyclic.hh"
 #include "SPBellmanFord.hh"
+#include "SPDeltaStepping.hh"
 #include "SPDikstra.hh"
 
 template <class SP>
@@ -53,6 +54,29 @@ int main() {
     assert(std::equal(DSP.distTo.begin(), DSP.distTo.end(), QBBF.distTo.begin(),
                       QBBF.distTo.end()));
 
+    DikstraSP CSRSP(CSRGraph<DirectedEdge>{EWD.V, EWD.edges()}, source);
+    assert(std::equal(DSP.distTo.begin(), DSP.distTo.end(),
+                      CSRSP.distTo.begin(), CSRSP.distTo.end()));
+
+    DikstraSP<DaryIndexMinPQ<int, 4>> DaryDSP(EWD, source);
+    assert(std::equal(DSP.distTo.begin(), DSP.distTo.end(),
+                      DaryDSP.distTo.begin(), DaryDSP.distTo.end()));
+    DikstraSP<RadixIndexMinPQ<int>> RadixDSP(EWD, source);
+    assert(std::equal(DSP.distTo.begin(), DSP.distTo.end(),
+                      RadixDSP.distTo.begin(), RadixDSP.distTo.end()));
+
+    for (int delta : {1, 3, 8})
+      for (int threads : {1, 4}) {
+        DeltaSteppingSP DSSP(EWD, source, delta, threads);
+        assert(std::equal(DSP.distTo.begin(), DSP.distTo.end(),
+                          DSSP.distTo.begin(), DSSP.distTo.end()));
+        for (int i = 0; i < v; ++i) {
+          int weight{0};
+          for (const auto &e : DSSP.pathTo(i)) weight += e.weight;
+          assert(!DSSP.hasPathTo(i) || weight == DSSP.distTo[i]);
+        }
+      }
+
     LazyDikstra LDSP(EWD, source);
     PRINTC("LazyDikstra", RED);
     printSP(LDSP, v);
@@ -0,0 +1,50 @@
+// make SearchBench CXXFLAGS="-std=c++23 -O2 -DNDEBUG"
+// the searches assert is_sorted on every call, so time with NDEBUG
+// usage: SearchBench.exe [keys] [keys per leaf]
+#include <chrono>
+#include <cstdlib>
+#include <print>
+#include <random>
+
+#include "SearchBinary.hh"
+#include "SearchBlock.hh"
+#include "SearchLearned.hh"
+
+template <class F>
+double nanosPerProbe(const std::vector<int> &probes, F &&f) {
+  long long sink{0};
+  auto start{std::chrono::steady_clock::now()};
+  for (int key : probes) sink += f(key);
+  std::chrono::duration<double, std::nano> elapsed{
+      std::chrono::steady_clock::now() - start};
+  // keeps the loop from being optimized away
+  if (sink == 42) std::print(" ");
+  return elapsed.count() / probes.size();
+}
+
+int main(int argc, char *argv[]) {
+  int n{argc > 1 ? std::atoi(argv[1]) : 1 << 22};
+  int perLeaf{argc > 2 ? std::atoi(argv[2]) : 256};
+  std::mt19937 mt(std::random_device{}());
+
+  // near-uniform keys, about 16 apart
+  std::uniform_int_distribution gap(8, 24);
+  ns::vector<int> A(n);
+  for (int i = 0, key = 0; i < n; i++) A[i] = key += gap(mt);
+  std::uniform_int_distribution randKey(A[0] - 16, A[n - 1] + 16);
+  std::vector<int> probes(1 << 20);
+  for (auto &key : probes) key = randKey(mt);
+
+  LearnedIndex<int> learned(A, perLeaf);
+  std::print("{} keys\t{} leaves\t{} bytes\tmax window {}\n", n,
+             learned.leaves.size(), learned.bytes(), learned.maxError());
+
+  auto bisection = [&](int k) { return bisectionSearch(k, A); };
+  auto model = [&](int k) { return learned.search(k); };
+  std::print("bisectionSearch\t{:.1f} ns\n", nanosPerProbe(probes, bisection));
+  std::print("LearnedIndex\t{:.1f} ns\n", nanosPerProbe(probes, model));
+  // blockSearch scans sqrt(n) blocks per probe, fewer probes suffice
+  std::vector<int> few(probes.begin(), probes.begin() + (1 << 12));
+  std::print("blockSearch\t{:.1f} ns\n",
+             nanosPerProbe(few, [&](int k) { return blockSearch(k, A); }));
+}
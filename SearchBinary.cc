@@ -1,94 +1,9 @@
-#include <algorithm>
-#include <cassert>
-#include <concepts>
 #include <cstdlib>
 #include <ctime>
 #include <print>
+#include <random>
 
-#include "vector.hh"
-
-// 折半查找
-template <typename T>
-  requires std::totally_ordered<T>
-int bisectionSearch(const T &key, const ns::vector<T> &A) {
-  assert(std::ranges::is_sorted(A));
-  int lo(0), hi(A.size() - 1);
-  while (lo <= hi) {
-    int mid{lo + (hi - lo) / 2};
-    if (key < A[mid])
-      hi = mid - 1;
-    else if (key > A[mid])
-      lo = mid + 1;
-    // key == A[mid]
-    else
-      return mid;
-  }
-  return -1;
-}
-
-// 斐波那契查找
-template <class T>
-  requires std::totally_ordered<T>
-int fibonacciSearch(const T &key, const ns::vector<T> &A) {
-  assert(std::ranges::is_sorted(A));
-  int lo = 0, hi = A.size() - 1;
-  int alpha{0}, beta{1}, x;
-  do {
-    x = alpha + beta;
-    alpha = beta;
-    beta = x;
-  } while (beta < hi - lo);
-
-  while (lo <= hi) {
-    while (beta > hi - lo) {
-      x = beta - alpha;
-      beta = alpha;
-      alpha = x;
-    }
-    int pivot{lo + beta};
-    if (key < A[pivot])
-      hi = pivot - 1;
-    else if (key > A[pivot])
-      lo = pivot + 1;
-    else
-      return pivot;
-  }
-  return -1;
-}
-
-// 大于等于查找目标的最小元素
-template <typename T>
-  requires std::totally_ordered<T>
-int rightBisection(const T &key, const ns::vector<T> &A) {
-  assert(std::ranges::is_sorted(A));
-  int lo(0), hi(A.size() - 1);
-  while (lo < hi) {
-    int mid{(lo + hi) >> 1};
-    if (key <= A[mid]) hi = mid;
-    // key > A[mid]
-    else
-      lo = mid + 1;
-  }
-  assert(lo == hi);
-  return hi;
-}
-
-// 小于等于查找目标的最大元素
-template <typename T>
-  requires std::totally_ordered<T>
-int leftBisection(const T &key, const ns::vector<T> &A) {
-  assert(std::ranges::is_sorted(A));
-  int lo(0), hi(A.size() - 1);
-  while (lo < hi) {
-    int mid = (lo + hi + 1) >> 1;
-    if (key >= A[mid]) lo = mid;
-    // key < A[mid]
-    else
-      hi = mid - 1;
-  }
-  assert(lo == hi);
-  return lo;
-}
+#include "SearchBinary.hh"
 
 int main() {
   std::srand(std::time(nullptr));
@@ -131,4 +46,46 @@ int main() {
   std::print("\n");
 
   assert(t == u || t == u + 1);
-}
\ No newline at end of file
+
+  // both layouts agree with the bisections on keys with duplicates
+  std::mt19937 mt(std::random_device{}());
+  for (int n : {1, 2, 15, 16, 17, 255, 256, 257, 1000, 4099}) {
+    std::uniform_int_distribution randKey(0, n);
+    ns::vector<int> A(n);
+    for (auto &e : A) e = randKey(mt);
+    std::ranges::sort(A);
+    EytzingerIndex<int> eytzinger(A);
+    STreeIndex<int> stree(A);
+    for (int key = -1; key <= n + 1; key++) {
+      int lower{eytzinger.lowerBound(key)}, upper{eytzinger.upperBound(key)};
+      assert(lower == std::ranges::lower_bound(A, key) - A.begin());
+      assert(upper == std::ranges::upper_bound(A, key) - A.begin());
+      assert(rightBisection(key, A) == std::min(lower, n - 1));
+      assert(leftBisection(key, A) == std::max(upper - 1, 0));
+      assert(stree.lowerBound(key) == lower && stree.upperBound(key) == upper);
+      int found{bisectionSearch(key, A)};
+      assert((found == -1) == (lower == upper));
+      assert(eytzinger.equal(key) == (lower < upper ? lower : -1));
+      assert(stree.equal(key) == eytzinger.equal(key));
+    }
+  }
+
+  // batches, shuffled and sorted, against one call per key
+  for (int n : {1, 2, 3, 100, 1 << 12}) {
+    std::uniform_int_distribution randKey(-1, n + 1);
+    ns::vector<int> A(n);
+    for (auto &e : A) e = randKey(mt);
+    std::ranges::sort(A);
+    std::vector<int> keys(1000), right(keys.size()), left(keys.size());
+    for (auto &e : keys) e = randKey(mt);
+    for (bool sorted : {false, true}) {
+      if (sorted) std::ranges::sort(keys);
+      rightBisection<int>(keys, A, right);
+      leftBisection<int>(keys, A, left);
+      for (std::size_t i = 0; i < keys.size(); i++) {
+        assert(right[i] == rightBisection(keys[i], A));
+        assert(left[i] == leftBisection(keys[i], A));
+      }
+    }
+  }
+}
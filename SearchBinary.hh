@@ -0,0 +1,333 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <span>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "vector.hh"
+
+// 折半查找
+template <typename T>
+  requires std::totally_ordered<T>
+int bisectionSearch(const T &key, const ns::vector<T> &A) {
+  assert(std::ranges::is_sorted(A));
+  int lo(0), hi(A.size() - 1);
+  while (lo <= hi) {
+    int mid{lo + (hi - lo) / 2};
+    if (key < A[mid])
+      hi = mid - 1;
+    else if (key > A[mid])
+      lo = mid + 1;
+    // key == A[mid]
+    else
+      return mid;
+  }
+  return -1;
+}
+
+// 斐波那契查找
+template <class T>
+  requires std::totally_ordered<T>
+int fibonacciSearch(const T &key, const ns::vector<T> &A) {
+  assert(std::ranges::is_sorted(A));
+  int lo = 0, hi = A.size() - 1;
+  int alpha{0}, beta{1}, x;
+  do {
+    x = alpha + beta;
+    alpha = beta;
+    beta = x;
+  } while (beta < hi - lo);
+
+  while (lo <= hi) {
+    while (beta > hi - lo) {
+      x = beta - alpha;
+      beta = alpha;
+      alpha = x;
+    }
+    int pivot{lo + beta};
+    if (key < A[pivot])
+      hi = pivot - 1;
+    else if (key > A[pivot])
+      lo = pivot + 1;
+    else
+      return pivot;
+  }
+  return -1;
+}
+
+// 大于等于查找目标的最小元素
+template <typename T>
+  requires std::totally_ordered<T>
+int rightBisection(const T &key, const ns::vector<T> &A) {
+  assert(std::ranges::is_sorted(A));
+  int lo(0), hi(A.size() - 1);
+  while (lo < hi) {
+    int mid{(lo + hi) >> 1};
+    if (key <= A[mid]) hi = mid;
+    // key > A[mid]
+    else
+      lo = mid + 1;
+  }
+  assert(lo == hi);
+  return hi;
+}
+
+// 小于等于查找目标的最大元素
+template <typename T>
+  requires std::totally_ordered<T>
+int leftBisection(const T &key, const ns::vector<T> &A) {
+  assert(std::ranges::is_sorted(A));
+  int lo(0), hi(A.size() - 1);
+  while (lo < hi) {
+    int mid = (lo + hi + 1) >> 1;
+    if (key >= A[mid]) lo = mid;
+    // key < A[mid]
+    else
+      hi = mid - 1;
+  }
+  assert(lo == hi);
+  return lo;
+}
+
+// batched bisection, out[i] answers keys[i]; every search over the same
+// array takes the same number of halving steps, so GROUP searches advance
+// in lockstep and each prefetches its next probe while the others compare
+template <bool upper, typename T>
+  requires std::totally_ordered<T>
+void interleavedBound(std::span<const T> keys, const ns::vector<T> &A,
+                      std::span<int> out) {
+  constexpr int GROUP{16};
+  int n{A.size()};
+  for (std::size_t g = 0; g < keys.size(); g += GROUP) {
+    int m = std::min<std::size_t>(GROUP, keys.size() - g);
+    int base[GROUP]{};
+    for (int len = n; len > 1;) {
+      int half{len / 2};
+      len -= half;
+      for (int j = 0; j < m; j++) {
+        const T &key{keys[g + j]};
+        const T &probe{A[base[j] + half - 1]};
+        base[j] += (upper ? !(key < probe) : probe < key) * half;
+#if defined(__GNUC__)
+        __builtin_prefetch(A.begin() + base[j] + len / 2 - 1);
+#endif
+      }
+    }
+    for (int j = 0; j < m; j++) {
+      const T &key{keys[g + j]};
+      out[g + j] = base[j] + (upper ? !(key < A[base[j]]) : A[base[j]] < key);
+    }
+  }
+}
+
+// sorted keys walk A once, galloping from the previous answer
+template <bool upper, typename T>
+  requires std::totally_ordered<T>
+void mergeBound(std::span<const T> keys, const ns::vector<T> &A,
+                std::span<int> out) {
+  int n{A.size()}, lo{0};
+  for (std::size_t i = 0; i < keys.size(); i++) {
+    auto before = [&](int j) {
+      return upper ? !(keys[i] < A[j]) : A[j] < keys[i];
+    };
+    int step{1}, hi{lo};
+    while (hi < n && before(hi)) lo = hi + 1, hi += step, step *= 2;
+    hi = std::min(hi, n);
+    while (lo < hi) {
+      int mid{lo + (hi - lo) / 2};
+      if (before(mid))
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    out[i] = lo;
+  }
+}
+
+template <bool upper, typename T>
+  requires std::totally_ordered<T>
+void batchBound(std::span<const T> keys, const ns::vector<T> &A,
+                std::span<int> out) {
+  assert(std::ranges::is_sorted(A) && A.size() > 0);
+  assert(out.size() >= keys.size());
+  if (std::ranges::is_sorted(keys))
+    mergeBound<upper>(keys, A, out);
+  else
+    interleavedBound<upper>(keys, A, out);
+}
+
+// out[i] = rightBisection(keys[i], A)
+template <typename T>
+  requires std::totally_ordered<T>
+void rightBisection(std::span<const T> keys, const ns::vector<T> &A,
+                    std::span<int> out) {
+  batchBound<false>(keys, A, out);
+  for (std::size_t i = 0; i < keys.size(); i++)
+    out[i] = std::min(out[i], A.size() - 1);
+}
+
+// out[i] = leftBisection(keys[i], A)
+template <typename T>
+  requires std::totally_ordered<T>
+void leftBisection(std::span<const T> keys, const ns::vector<T> &A,
+                   std::span<int> out) {
+  batchBound<true>(keys, A, out);
+  for (std::size_t i = 0; i < keys.size(); i++)
+    out[i] = std::max(out[i] - 1, 0);
+}
+
+// A in BFS order of the implicit binary search tree (Eytzinger), the
+// children of k are 2k and 2k + 1; the search is branchless and the
+// cache line holding the great-great-grandchildren is prefetched
+template <typename T>
+  requires std::totally_ordered<T>
+struct EytzingerIndex {
+  static constexpr int PREFETCH{64 / sizeof(T) > 1 ? 64 / sizeof(T) : 1};
+  int n;
+  // 1-indexed, rank[k] is the index of b[k] in A
+  ns::vector<T> b;
+  ns::vector<int> rank;
+
+  explicit EytzingerIndex(const ns::vector<T> &A)
+      : n{A.size()}, b(A.size() + 1), rank(A.size() + 1) {
+    assert(std::ranges::is_sorted(A));
+    int i{0};
+    build(A, i, 1);
+  }
+
+  void build(const ns::vector<T> &A, int &i, int k) {
+    if (k > n) return;
+    build(A, i, 2 * k);
+    b[k] = A[i];
+    rank[k] = i++;
+    build(A, i, 2 * k + 1);
+  }
+
+  // the path turns right on every probe below the key, the answer is the
+  // node where it last turned left, 0 if it never did
+  template <class Less>
+  int descend(Less less) const {
+    int k{1};
+    while (k <= n) {
+#if defined(__GNUC__)
+      __builtin_prefetch(b.begin() + (long long)k * PREFETCH);
+#endif
+      k = 2 * k + less(b[k]);
+    }
+    return k >> (std::countr_one((unsigned)k) + 1);
+  }
+
+  // first element >= key, n if none
+  int lowerBound(const T &key) const {
+    int k{descend([&](const T &x) { return x < key; })};
+    return k ? rank[k] : n;
+  }
+
+  // first element > key, n if none
+  int upperBound(const T &key) const {
+    int k{descend([&](const T &x) { return !(key < x); })};
+    return k ? rank[k] : n;
+  }
+
+  // index of the first element == key, -1 if none
+  int equal(const T &key) const {
+    int k{descend([&](const T &x) { return x < key; })};
+    return k && !(key < b[k]) ? rank[k] : -1;
+  }
+};
+
+// static B-tree (S-tree) of B keys per node in one array, node k has
+// children k(B + 1) + i + 1; a node is one or two cache lines and is
+// ranked against the key with SIMD compares when T is int
+template <typename T>
+  requires std::totally_ordered<T>
+struct STreeIndex {
+  static constexpr int B{16};
+  int n, blocks;
+  // the tail of the last node is padded with copies of the largest key,
+  // their rank is n
+  ns::vector<T> keys;
+  ns::vector<int> rank;
+
+  explicit STreeIndex(const ns::vector<T> &A)
+      : n{A.size()},
+        blocks{(A.size() + B - 1) / B},
+        keys(blocks * B),
+        rank(blocks * B) {
+    assert(std::ranges::is_sorted(A));
+    int i{0};
+    build(A, i, 0);
+  }
+
+  static int child(int k, int i) { return k * (B + 1) + i + 1; }
+
+  void build(const ns::vector<T> &A, int &i, int k) {
+    if (k >= blocks) return;
+    for (int j = 0; j < B; j++) {
+      build(A, i, child(k, j));
+      keys[k * B + j] = A[std::min(i, n - 1)];
+      rank[k * B + j] = std::min(i++, n);
+    }
+    build(A, i, child(k, B));
+  }
+
+  // count of node keys < key, or <= key when inclusive
+  template <bool inclusive>
+  static int count(const T *node, const T &key) {
+#if defined(__AVX2__)
+    if constexpr (std::same_as<T, int>) {
+      __m256i x{_mm256_set1_epi32(key)};
+      unsigned mask{0};
+      for (int j = 0; j < B; j += 8) {
+        auto y{_mm256_loadu_si256((const __m256i *)(node + j))};
+        auto gt{inclusive ? _mm256_cmpgt_epi32(y, x)
+                          : _mm256_cmpgt_epi32(x, y)};
+        mask |= _mm256_movemask_ps(_mm256_castsi256_ps(gt)) << j;
+      }
+      return std::popcount(inclusive ? ~mask & 0xffff : mask);
+    }
+#elif defined(__SSE2__)
+    if constexpr (std::same_as<T, int>) {
+      __m128i x{_mm_set1_epi32(key)};
+      unsigned mask{0};
+      for (int j = 0; j < B; j += 4) {
+        auto y{_mm_loadu_si128((const __m128i *)(node + j))};
+        auto gt{inclusive ? _mm_cmpgt_epi32(y, x) : _mm_cmpgt_epi32(x, y)};
+        mask |= _mm_movemask_ps(_mm_castsi128_ps(gt)) << j;
+      }
+      return std::popcount(inclusive ? ~mask & 0xffff : mask);
+    }
+#endif
+    int c{0};
+    for (int j = 0; j < B; j++)
+      c += inclusive ? !(key < node[j]) : node[j] < key;
+    return c;
+  }
+
+  template <bool inclusive>
+  int descend(const T &key) const {
+    int k{0}, found{n};
+    while (k < blocks) {
+      int i{count<inclusive>(keys.begin() + k * B, key)};
+      if (i < B) found = rank[k * B + i];
+      k = child(k, i);
+    }
+    return found;
+  }
+
+  // first element >= key, n if none
+  int lowerBound(const T &key) const { return descend<false>(key); }
+
+  // first element > key, n if none
+  int upperBound(const T &key) const { return descend<true>(key); }
+
+  // index of the first element == key, -1 if none
+  int equal(const T &key) const {
+    int i{lowerBound(key)}, j{upperBound(key)};
+    return i < j ? i : -1;
+  }
+};
@@ -1,41 +1,9 @@
-#include <cassert>
-#include <concepts>
 #include <ctime>
+#include <limits>
 #include <print>
+#include <random>
 
-#include "vector.hh"
-
-// 线性查找
-template <typename compar>
-  requires std::equality_comparable<compar>
-int linearSearch(const compar &key, const ns::vector<compar> &A) {
-  for (int i(0), sz(A.size()); i < sz; ++i)
-    if (A[i] == key) return i;
-  return -1;
-}
-
-// 分块查找
-template <typename compar>
-  requires std::totally_ordered<compar>
-int blockSearch(const compar &key, const ns::vector<compar> &A) {
-  assert(std::ranges::is_sorted(A));
-  int n = A.size(), block = 1;
-  while (block * block <= n) block++;
-
-  int hi = 0;
-  for (; hi < n; hi += block) {
-    if (key < A[hi]) break;
-  }
-
-  if (hi > 0) {
-    int i{hi - block};
-    if (n <= hi) hi = n;
-    for (; i < hi; i++)
-      if (key == A[i]) return i;
-  }
-
-  return -1;
-}
+#include "SearchBlock.hh"
 
 int main() {
   std::srand(std::time(nullptr));
@@ -70,4 +38,42 @@ int main() {
   assert(blockSearch<int>(vec.back() + 1, vec) == -1);
 
   assert(r == s);
-}
\ No newline at end of file
+
+  // every kernel against the scalar scan, sorted arrays for lower bounds
+  std::mt19937 mt(std::random_device{}());
+  auto check = [&]<class T>(T) {
+    using limits = std::numeric_limits<T>;
+    for (int n = 0; n < 70; n++) {
+      ns::vector<T> A(n);
+      for (auto &e : A)
+        e = mt() % 2   ? T(mt() % 16)
+            : mt() % 2 ? limits::max()
+                       : limits::lowest();
+      std::ranges::sort(A);
+      for (int j = 0; j <= n; j++) {
+        T key{j < n ? A[j] : T(mt() % 16)};
+        int equal{scanScalar<false>(A.begin(), n, key)};
+        int lower{scanScalar<true>(A.begin(), n, key)};
+        assert(scan<false>(A.begin(), n, key) == equal);
+        assert(scan<true>(A.begin(), n, key) == lower);
+#if SEARCH_SIMD
+        if constexpr (simdScannable<T>) {
+          if (__builtin_cpu_supports("avx2")) {
+            assert(scanAVX2<false>(A.begin(), n, key) == equal);
+            assert(scanAVX2<true>(A.begin(), n, key) == lower);
+          }
+          if (__builtin_cpu_supports("sse4.2")) {
+            assert(scanSSE4<false>(A.begin(), n, key) == equal);
+            assert(scanSSE4<true>(A.begin(), n, key) == lower);
+          }
+        }
+#endif
+        assert(linearSearch(key, A) == (equal < n ? equal : -1));
+        int block{blockSearch(key, A)};
+        assert(block == -1 ? equal == n : A[block] == key);
+      }
+    }
+  };
+  check(0), check(0u), check(0LL), check(0ULL), check(0.0f), check(0.0);
+  check((short)0), check((char)0);
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <type_traits>
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SEARCH_SIMD 1
+#include <immintrin.h>
+#endif
+
+#include "vector.hh"
+
+// scan kernels: the first i in [0, n) with a[i] == key, or with
+// !(a[i] < key) for the lower-bound scan, n if none
+
+template <bool lower, class T>
+int scanScalar(const T *a, int n, const T &key) {
+  for (int i = 0; i < n; i++)
+    if constexpr (lower) {
+      if (!(a[i] < key)) return i;
+    } else if (a[i] == key)
+      return i;
+  return n;
+}
+
+template <class T>
+concept simdScannable =
+    (std::integral<T> || std::floating_point<T>) &&
+    (sizeof(T) == 4 || sizeof(T) == 8) && !std::same_as<T, long double>;
+
+#if SEARCH_SIMD
+// one bit per lane; unsigned lanes are biased into signed order
+template <bool lower, class T>
+[[gnu::target("avx2")]] unsigned laneMask(const T *p, const T &key) {
+  if constexpr (std::same_as<T, float>) {
+    __m256 x{_mm256_loadu_ps(p)}, k{_mm256_set1_ps(key)};
+    return _mm256_movemask_ps(
+        _mm256_cmp_ps(x, k, lower ? _CMP_NLT_UQ : _CMP_EQ_OQ));
+  } else if constexpr (std::same_as<T, double>) {
+    __m256d x{_mm256_loadu_pd(p)}, k{_mm256_set1_pd(key)};
+    return _mm256_movemask_pd(
+        _mm256_cmp_pd(x, k, lower ? _CMP_NLT_UQ : _CMP_EQ_OQ));
+  } else if constexpr (sizeof(T) == 4) {
+    __m256i x{_mm256_loadu_si256((const __m256i *)p)};
+    __m256i k{_mm256_set1_epi32(key)};
+    if (!lower)
+      return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, k)));
+    if constexpr (std::is_unsigned_v<T>) {
+      __m256i bias{_mm256_set1_epi32(0x80000000)};
+      x = _mm256_xor_si256(x, bias), k = _mm256_xor_si256(k, bias);
+    }
+    return ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(k, x))) &
+           0xff;
+  } else {
+    __m256i x{_mm256_loadu_si256((const __m256i *)p)};
+    __m256i k{_mm256_set1_epi64x(key)};
+    if (!lower)
+      return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(x, k)));
+    if constexpr (std::is_unsigned_v<T>) {
+      __m256i bias{_mm256_set1_epi64x(0x8000000000000000)};
+      x = _mm256_xor_si256(x, bias), k = _mm256_xor_si256(k, bias);
+    }
+    return ~_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(k, x))) &
+           0xf;
+  }
+}
+
+template <bool lower, class T>
+[[gnu::target("sse4.2")]] unsigned laneMask128(const T *p, const T &key) {
+  if constexpr (std::same_as<T, float>) {
+    __m128 x{_mm_loadu_ps(p)}, k{_mm_set1_ps(key)};
+    return _mm_movemask_ps(lower ? _mm_cmpnlt_ps(x, k) : _mm_cmpeq_ps(x, k));
+  } else if constexpr (std::same_as<T, double>) {
+    __m128d x{_mm_loadu_pd(p)}, k{_mm_set1_pd(key)};
+    return _mm_movemask_pd(lower ? _mm_cmpnlt_pd(x, k) : _mm_cmpeq_pd(x, k));
+  } else if constexpr (sizeof(T) == 4) {
+    __m128i x{_mm_loadu_si128((const __m128i *)p)}, k{_mm_set1_epi32(key)};
+    if (!lower) return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, k)));
+    if constexpr (std::is_unsigned_v<T>) {
+      __m128i bias{_mm_set1_epi32(0x80000000)};
+      x = _mm_xor_si128(x, bias), k = _mm_xor_si128(k, bias);
+    }
+    return ~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(k, x))) & 0xf;
+  } else {
+    __m128i x{_mm_loadu_si128((const __m128i *)p)}, k{_mm_set1_epi64x(key)};
+    if (!lower) return _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(x, k)));
+    if constexpr (std::is_unsigned_v<T>) {
+      __m128i bias{_mm_set1_epi64x(0x8000000000000000)};
+      x = _mm_xor_si128(x, bias), k = _mm_xor_si128(k, bias);
+    }
+    return ~_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(k, x))) & 0x3;
+  }
+}
+
+template <bool lower, class T>
+  requires simdScannable<T>
+[[gnu::target("avx2")]] int scanAVX2(const T *a, int n, const T &key) {
+  constexpr int W = 32 / sizeof(T);
+  int i{0};
+  for (; i + W <= n; i += W)
+    if (unsigned m{laneMask<lower>(a + i, key)}) return i + std::countr_zero(m);
+  return i + scanScalar<lower>(a + i, n - i, key);
+}
+
+template <bool lower, class T>
+  requires simdScannable<T>
+[[gnu::target("sse4.2")]] int scanSSE4(const T *a, int n, const T &key) {
+  constexpr int W = 16 / sizeof(T);
+  int i{0};
+  for (; i + W <= n; i += W)
+    if (unsigned m{laneMask128<lower>(a + i, key)})
+      return i + std::countr_zero(m);
+  return i + scanScalar<lower>(a + i, n - i, key);
+}
+#endif
+
+// picks the widest kernel the CPU runs, once per type
+template <bool lower, class T>
+int scan(const T *a, int n, const T &key) {
+#if SEARCH_SIMD
+  if constexpr (simdScannable<T>) {
+    using Kernel = int (*)(const T *, int, const T &);
+    static const Kernel kernel = [] {
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2")) return Kernel{scanAVX2<lower, T>};
+      if (__builtin_cpu_supports("sse4.2")) return Kernel{scanSSE4<lower, T>};
+      return Kernel{scanScalar<lower, T>};
+    }();
+    return kernel(a, n, key);
+  }
+#endif
+  return scanScalar<lower>(a, n, key);
+}
+
+// 线性查找
+template <typename compar>
+  requires std::equality_comparable<compar>
+int linearSearch(const compar &key, const ns::vector<compar> &A) {
+  int i{scan<false>(A.begin(), A.size(), key)};
+  return i < A.size() ? i : -1;
+}
+
+// 分块查找
+template <typename compar>
+  requires std::totally_ordered<compar>
+int blockSearch(const compar &key, const ns::vector<compar> &A) {
+  assert(std::ranges::is_sorted(A));
+  int n = A.size(), block = 1;
+  while (block * block <= n) block++;
+
+  int hi = 0;
+  for (; hi < n; hi += block) {
+    if (key < A[hi]) break;
+  }
+
+  if (hi > 0) {
+    int i{hi - block};
+    if (n <= hi) hi = n;
+    i += scan<true>(A.begin() + i, hi - i, key);
+    if (i < hi && key == A[i]) return i;
+  }
+
+  return -1;
+}
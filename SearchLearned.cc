@@ -0,0 +1,72 @@
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <print>
+#include <random>
+
+#include "SearchLearned.hh"
+
+// every bound of the index against std::ranges, probing each key, its
+// neighbours and the extremes of T
+template <class T>
+void check(const LearnedIndex<T> &index, const ns::vector<T> &A) {
+  std::vector<T> probes{std::numeric_limits<T>::lowest(),
+                        std::numeric_limits<T>::max()};
+  for (const auto &x : A) {
+    probes.push_back(x);
+    if (x > std::numeric_limits<T>::lowest()) probes.push_back(x - 1);
+    if (x < std::numeric_limits<T>::max()) probes.push_back(x + 1);
+  }
+  for (const auto &key : probes) {
+    int lower = std::ranges::lower_bound(A, key) - A.begin();
+    int upper = std::ranges::upper_bound(A, key) - A.begin();
+    assert(index.lowerBound(key) == lower);
+    assert(index.upperBound(key) == upper);
+    assert(index.search(key) == (lower < upper ? lower : -1));
+  }
+}
+
+int main() {
+  std::mt19937 mt(std::random_device{}());
+  auto sorted = [](std::vector<int> keys) {
+    std::ranges::sort(keys);
+    ns::vector<int> A(keys.size());
+    for (int i = 0; i < A.size(); i++) A[i] = keys[i];
+    return A;
+  };
+
+  // the index keeps its own copy, a temporary is fine
+  LearnedIndex<int> temporary(ns::vector<int>{1, 3, 5, 7, 9});
+  assert(temporary.search(7) == 3 && temporary.search(4) == -1);
+
+  std::exponential_distribution<> skew(1e-4);
+  std::uniform_int_distribution<int> any(std::numeric_limits<int>::min(),
+                                         std::numeric_limits<int>::max());
+  for (int n : {0, 1, 2, 3, 17, 1000, 50000})
+    for (int perLeaf : {1, 4, 256}) {
+      std::vector<int> uniform(n), duplicates(n), skewed(n), extreme(n);
+      for (int i = 0; i < n; i++) {
+        uniform[i] = mt() % (16 * n + 1);
+        duplicates[i] = mt() % 8;
+        skewed[i] = std::min(1e9, std::pow(skew(mt), 2));
+        extreme[i] = i % 3 == 0   ? std::numeric_limits<int>::min()
+                     : i % 3 == 1 ? std::numeric_limits<int>::max()
+                                  : any(mt);
+      }
+      for (const auto &keys : {uniform, duplicates, skewed, extreme}) {
+        auto A{sorted(keys)};
+        LearnedIndex<int> index(A, perLeaf);
+        check(index, A);
+      }
+    }
+
+  ns::vector<double> D(1000);
+  for (int i = 0; i < D.size(); i++) D[i] = std::pow(1.01, i) - 1;
+  check(LearnedIndex<double>(D, 16), D);
+
+  std::vector<int> keys(1 << 16);
+  for (auto &key : keys) key = mt() % (1 << 24);
+  LearnedIndex<int> big(sorted(keys), 64);
+  std::print("{} leaves\t{} bytes\tmax window {}\n", big.leaves.size(),
+             big.bytes(), big.maxError());
+}
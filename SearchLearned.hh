@@ -0,0 +1,125 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <concepts>
+#include <vector>
+
+#include "vector.hh"
+
+// two-level recursive model index (Kraska et al.) over a sorted vector,
+// copied like EytzingerIndex does; the root line sends a key to one of the
+// leaf lines, which predicts its position; the worst under- and overshoot
+// of every leaf are measured at build time, so a lookup only bisects a
+// window of that width
+template <class T>
+  requires std::integral<T> || std::floating_point<T>
+struct LearnedIndex {
+  struct Leaf {
+    double slope{0}, intercept{0};
+    // keys routed here are A[first, last)
+    int first{0}, last{0};
+    // i - predict(A[i]) stays in [below, above]
+    int below{0}, above{0};
+  };
+
+  ns::vector<T> A;
+  double rootSlope{0}, rootIntercept{0};
+  std::vector<Leaf> leaves;
+
+  // one leaf per keysPerLeaf keys on average
+  explicit LearnedIndex(const ns::vector<T> &A, int keysPerLeaf = 256)
+      : A{A}, leaves(std::max(1, A.size() / keysPerLeaf)) {
+    assert(std::ranges::is_sorted(A) && keysPerLeaf > 0);
+    int n{A.size()}, m = leaves.size();
+    if (n == 0) return;
+    double span = (double)A[n - 1] - (double)A[0];
+    if (span > 0) rootSlope = m / span;
+    rootIntercept = -rootSlope * (double)A[0];
+
+    // the root is monotone, so each leaf gets a contiguous run
+    for (int i = 0, l = 0; l < m; l++) {
+      leaves[l].first = i;
+      while (i < n && route(A[i]) == l) i++;
+      leaves[l].last = i;
+    }
+    for (auto &leaf : leaves) fit(leaf);
+  }
+
+  int route(const T &key) const {
+    double l{rootSlope * (double)key + rootIntercept};
+    return std::clamp<double>(l, 0, leaves.size() - 1);
+  }
+
+  // least squares line through (A[i], i), then its error bounds
+  void fit(Leaf &leaf) {
+    int count{leaf.last - leaf.first};
+    if (count == 0) {
+      leaf.intercept = leaf.first;
+      return;
+    }
+    double meanX{0}, meanY{0};
+    for (int i = leaf.first; i < leaf.last; i++)
+      meanX += (double)A[i], meanY += i;
+    meanX /= count, meanY /= count;
+    double cov{0}, var{0};
+    for (int i = leaf.first; i < leaf.last; i++) {
+      double dx{(double)A[i] - meanX};
+      cov += dx * (i - meanY), var += dx * dx;
+    }
+    leaf.slope = var > 0 ? cov / var : 0;
+    leaf.intercept = meanY - leaf.slope * meanX;
+    double lo{0}, hi{0};
+    for (int i = leaf.first; i < leaf.last; i++) {
+      double error{i - predict(leaf, A[i])};
+      lo = std::min(lo, error), hi = std::max(hi, error);
+    }
+    leaf.below = std::floor(lo), leaf.above = std::ceil(hi);
+  }
+
+  static double predict(const Leaf &leaf, const T &key) {
+    return leaf.slope * (double)key + leaf.intercept;
+  }
+
+  // widest window a lookup bisects
+  int maxError() const {
+    int error{0};
+    for (const auto &leaf : leaves)
+      error = std::max(error, leaf.above - leaf.below + 1);
+    return error;
+  }
+
+  // bytes of the model, the copy of the keys aside
+  std::size_t bytes() const { return leaves.size() * sizeof(Leaf); }
+
+  // the answer lies in the leaf's run, and within its error of the
+  // prediction since the line is monotone between neighbouring keys
+  template <class Less>
+  int bound(const T &key, Less less) const {
+    if (A.size() == 0) return 0;
+    const Leaf &leaf{leaves[route(key)]};
+    double guess{predict(leaf, key)};
+    int lo = std::clamp<double>(std::floor(guess) + leaf.below, leaf.first,
+                                leaf.last);
+    int hi = std::clamp<double>(std::ceil(guess) + leaf.above + 1, lo,
+                                leaf.last);
+    return std::partition_point(A.begin() + lo, A.begin() + hi, less) -
+           A.begin();
+  }
+
+  // first element >= key, n if none
+  int lowerBound(const T &key) const {
+    return bound(key, [&](const T &x) { return x < key; });
+  }
+
+  // first element > key, n if none
+  int upperBound(const T &key) const {
+    return bound(key, [&](const T &x) { return !(key < x); });
+  }
+
+  // index of the first element == key, -1 if none
+  int search(const T &key) const {
+    int i{lowerBound(key)};
+    return i < A.size() && A[i] == key ? i : -1;
+  }
+};
@@ -1,109 +1,4 @@
-#include <mutex>
-#include <print>
-#include <random>
-#include <shared_mutex>
-#include <string_view>
-#include <vector>
-
-template <class K, class V, class RNG = std::mt19937, int MaxLevel = 8>
-struct SkipList {
-  struct Node {
-    std::vector<Node *> forward;
-    K key;
-    V value;
-    Node(int lvl) : forward(lvl, nullptr) {}
-    Node(int lvl, K k, V v) : forward(lvl), key{k}, value{v} {}
-  };
-  int level;
-  Node *header;
-  RNG mt;
-  std::uniform_int_distribution<int> rand;
-  std::shared_mutex rw{};
-
-  SkipList()
-      : level{1},
-        header{new Node(MaxLevel)},
-        mt(std::random_device{}()),
-        rand(0, 99) {}
-
-  ~SkipList() {
-    while (header) {
-      Node *next{header->forward[0]};
-      delete header;
-      header = next;
-    }
-  }
-
-  auto search(K searchKey) -> Node * {
-    std::shared_lock lk(rw);
-    Node *x{header};
-    for (int i = level - 1; i >= 0; i--) {
-      while (x->forward[i] && x->forward[i]->key < searchKey) x = x->forward[i];
-    }
-    x = x->forward[0];
-    if (x && x->key == searchKey)
-      return x;
-    else
-      return nullptr;
-  }
-
-  auto insert(K searchKey, V newValue) -> void {
-    std::unique_lock lk(rw);
-    std::vector<Node *> update(MaxLevel);
-    Node *x{header};
-    for (int i = level - 1; i >= 0; i--) {
-      while (x->forward[i] && x->forward[i]->key < searchKey) x = x->forward[i];
-      update[i] = x;
-    }
-    x = x->forward[0];
-    if (x && x->key == searchKey)
-      x->value = newValue;
-    else {
-      int lvl{randomLevel()};
-      if (lvl > level) {
-        for (int i = level; i < lvl; i++) update[i] = header;
-        level = lvl;
-      }
-
-      // lvl NOT MaxLevel
-      auto y{new Node(lvl, searchKey, newValue)};
-      for (int i = 0; i < lvl; i++) {
-        y->forward[i] = update[i]->forward[i];
-        update[i]->forward[i] = y;
-      }
-    }
-  }
-
-  auto remove(K searchKey) -> void {
-    std::unique_lock lk(rw);
-    std::vector<Node *> update(MaxLevel);
-    Node *x{header};
-    for (int i = level - 1; i >= 0; i--) {
-      while (x->forward[i] && x->forward[i]->key < searchKey) x = x->forward[i];
-      update[i] = x;
-    }
-    x = x->forward[0];
-    if (x && x->key == searchKey) {
-      for (int i = 0; i < level; i++) {
-        if (update[i]->forward[i] != x) break;
-        update[i]->forward[i] = x->forward[i];
-      }
-      delete x;
-      while (level > 1 && header->forward[level - 1] == nullptr) level--;
-    }
-  }
-
-  auto randomLevel() -> int {
-    int lvl{1};
-    while (rand(mt) < 50 && lvl < MaxLevel) lvl++;
-    return lvl;
-  }
-
-  auto printList() -> void {
-    for (auto e{header->forward[0]}; e; e = e->forward[0])
-      std::print("{}->{}\t", e->key, e->value);
-  }
-};
+#include "SkipList.hh"
 
 auto main() -> int {
   std::mt19937 mt(std::random_device{}());
@@ -125,4 +20,73 @@ auto main() -> int {
     l.printList();
     std::print("\n");
   }
+  std::print("\033[0m");
+
+  // recycled blocks must keep the arena list in step with the vector one
+  ArenaSkipList<int, int, std::mt19937, 4> arena(0.5);
+  std::uniform_int_distribution randK(0, 255);
+  for (int i = 0; i < 1 << 14; i++) {
+    int k{randK(mt)};
+    if (i % 3)
+      l.insert(k, i), arena.insert(k, i);
+    else
+      l.remove(k), arena.remove(k);
+    auto x{l.search(k)};
+    auto y{arena.search(k)};
+    assert(!x == !y && (!x || x->value == y->value));
+  }
+
+  // threads own the keys t, t + threads, ... and churn the shared ones
+  constexpr int threads{8}, keys{1 << 12};
+  LockFreeSkipList<int, int> lf;
+  {
+    std::vector<std::jthread> pool;
+    for (int t = 0; t < threads; t++)
+      pool.emplace_back([&lf, t] {
+        for (int k = t; k < keys; k += threads) lf.insert(k, k);
+        for (int k = t; k < keys; k += 2 * threads) lf.remove(k);
+        for (int k = 0; k < keys; k++) {
+          lf.insert(keys + k % 64, t);
+          lf.remove(keys + (k + t) % 64);
+          if (auto v{lf.search(k)}) assert(*v == k);
+        }
+      });
+  }
+  int prev{-1}, count{0};
+  lf.range(0, keys, [&](int k, int v) {
+    assert(prev < k && k == v && k % (2 * threads) >= threads);
+    prev = k, count++;
+  });
+  assert(count == keys / 2);
+  for (int k = 0; k < keys; k++)
+    assert(lf.search(k).has_value() == (k % (2 * threads) >= threads));
+
+  // ranges taken while odd keys churn must see every even key, present
+  // throughout
+  LockFreeSkipList<int, int> churn;
+  for (int k = 0; k < keys; k += 2) churn.insert(k, k);
+  {
+    std::atomic<bool> done{false};
+    std::vector<std::jthread> pool;
+    for (int t = 0; t < 4; t++)
+      pool.emplace_back([&churn, &done, t] {
+        std::mt19937 mt(t);
+        while (!done.load()) {
+          int k = mt() % keys | 1;
+          if (mt() & 1)
+            churn.insert(k, k);
+          else
+            churn.remove(k);
+        }
+      });
+    for (int round = 0; round < 200; round++) {
+      int even{0};
+      churn.range(0, keys, [&](int k, int v) {
+        assert(k == v);
+        if (k % 2 == 0) assert(k == even), even += 2;
+      });
+      assert(even == keys);
+    }
+    done.store(true);
+  }
 }
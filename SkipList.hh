@@ -0,0 +1,527 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <print>
+#include <random>
+#include <shared_mutex>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <class K, class V, class RNG = std::mt19937, int MaxLevel = 8>
+struct SkipList {
+  struct Node {
+    std::vector<Node *> forward;
+    K key;
+    V value;
+    Node(int lvl) : forward(lvl, nullptr) {}
+    Node(int lvl, K k, V v) : forward(lvl), key{k}, value{v} {}
+  };
+  int level;
+  Node *header;
+  RNG mt;
+  std::uniform_int_distribution<int> rand;
+  std::shared_mutex rw{};
+
+  SkipList()
+      : level{1},
+        header{new Node(MaxLevel)},
+        mt(std::random_device{}()),
+        rand(0, 99) {}
+
+  ~SkipList() {
+    while (header) {
+      Node *next{header->forward[0]};
+      delete header;
+      header = next;
+    }
+  }
+
+  auto search(K searchKey) -> Node * {
+    std::shared_lock lk(rw);
+    Node *x{header};
+    for (int i = level - 1; i >= 0; i--) {
+      while (x->forward[i] && x->forward[i]->key < searchKey) x = x->forward[i];
+    }
+    x = x->forward[0];
+    if (x && x->key == searchKey)
+      return x;
+    else
+      return nullptr;
+  }
+
+  auto insert(K searchKey, V newValue) -> void {
+    std::unique_lock lk(rw);
+    std::vector<Node *> update(MaxLevel);
+    Node *x{header};
+    for (int i = level - 1; i >= 0; i--) {
+      while (x->forward[i] && x->forward[i]->key < searchKey) x = x->forward[i];
+      update[i] = x;
+    }
+    x = x->forward[0];
+    if (x && x->key == searchKey)
+      x->value = newValue;
+    else {
+      int lvl{randomLevel()};
+      if (lvl > level) {
+        for (int i = level; i < lvl; i++) update[i] = header;
+        level = lvl;
+      }
+
+      // lvl NOT MaxLevel
+      auto y{new Node(lvl, searchKey, newValue)};
+      for (int i = 0; i < lvl; i++) {
+        y->forward[i] = update[i]->forward[i];
+        update[i]->forward[i] = y;
+      }
+    }
+  }
+
+  auto remove(K searchKey) -> void {
+    std::unique_lock lk(rw);
+    std::vector<Node *> update(MaxLevel);
+    Node *x{header};
+    for (int i = level - 1; i >= 0; i--) {
+      while (x->forward[i] && x->forward[i]->key < searchKey) x = x->forward[i];
+      update[i] = x;
+    }
+    x = x->forward[0];
+    if (x && x->key == searchKey) {
+      for (int i = 0; i < level; i++) {
+        if (update[i]->forward[i] != x) break;
+        update[i]->forward[i] = x->forward[i];
+      }
+      delete x;
+      while (level > 1 && header->forward[level - 1] == nullptr) level--;
+    }
+  }
+
+  auto randomLevel() -> int {
+    int lvl{1};
+    while (rand(mt) < 50 && lvl < MaxLevel) lvl++;
+    return lvl;
+  }
+
+  auto printList() -> void {
+    for (auto e{header->forward[0]}; e; e = e->forward[0])
+      std::print("{}->{}\t", e->key, e->value);
+  }
+};
+
+// the forward pointers trail the node in one block carved from a per-list
+// arena, freed blocks are recycled per level; a key is promoted with
+// probability p, MaxLevel should cover log(1/p) of the expected size
+template <class K, class V, class RNG = std::mt19937, int MaxLevel = 32>
+struct ArenaSkipList {
+  struct alignas(void *) Node {
+    K key;
+    V value;
+    int top;
+    Node(int top, K k, V v) : key{k}, value{v}, top{top} {}
+    auto forward() -> Node ** { return reinterpret_cast<Node **>(this + 1); }
+  };
+  static_assert(alignof(Node) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+  // size classes by level, bump allocation from 64 KiB chunks
+  struct Arena {
+    static constexpr std::size_t CHUNK{1 << 16};
+    std::vector<void *> chunks;
+    char *cur{nullptr}, *end{nullptr};
+    void *free[MaxLevel + 1]{};
+
+    Arena() = default;
+    Arena(const Arena &) = delete;
+    ~Arena() {
+      for (auto chunk : chunks) operator delete(chunk);
+    }
+
+    static auto bytes(int top) -> std::size_t {
+      return sizeof(Node) + top * sizeof(Node *);
+    }
+
+    auto allocate(int top) -> void * {
+      if (void *x{free[top]}) {
+        free[top] = *static_cast<void **>(x);
+        return x;
+      }
+      std::size_t n{bytes(top)};
+      if (cur + n > end) {
+        std::size_t size{std::max(CHUNK, n)};
+        cur = static_cast<char *>(operator new(size));
+        end = cur + size;
+        chunks.push_back(cur);
+      }
+      return std::exchange(cur, cur + n);
+    }
+
+    auto deallocate(void *x, int top) -> void {
+      *static_cast<void **>(x) = free[top];
+      free[top] = x;
+    }
+  };
+
+  int level;
+  Arena arena;
+  Node *header;
+  RNG mt;
+  std::bernoulli_distribution promote;
+  std::shared_mutex rw{};
+
+  explicit ArenaSkipList(double p = 0.25)
+      : level{1},
+        header{create(MaxLevel, K{}, V{})},
+        mt(std::random_device{}()),
+        promote(p) {
+    assert(0 < p && p < 1);
+  }
+
+  ~ArenaSkipList() {
+    for (Node *x{header}; x;) {
+      Node *next{x->forward()[0]};
+      x->~Node();
+      x = next;
+    }
+  }
+
+  auto create(int lvl, K key, V value) -> Node * {
+    Node *x{new (arena.allocate(lvl)) Node(lvl, key, value)};
+    std::fill_n(x->forward(), lvl, nullptr);
+    return x;
+  }
+
+  auto destroy(Node *x) -> void {
+    int top{x->top};
+    x->~Node();
+    arena.deallocate(x, top);
+  }
+
+  auto search(K searchKey) -> Node * {
+    std::shared_lock lk(rw);
+    Node *x{header};
+    for (int i = level - 1; i >= 0; i--) {
+      Node *next;
+      while ((next = x->forward()[i]) && next->key < searchKey) x = next;
+    }
+    x = x->forward()[0];
+    if (x && x->key == searchKey)
+      return x;
+    else
+      return nullptr;
+  }
+
+  // update[i] is the rightmost node at level i before searchKey
+  auto descend(K searchKey, Node **update) -> Node * {
+    Node *x{header};
+    for (int i = level - 1; i >= 0; i--) {
+      Node *next;
+      while ((next = x->forward()[i]) && next->key < searchKey) x = next;
+      update[i] = x;
+    }
+    return x->forward()[0];
+  }
+
+  auto insert(K searchKey, V newValue) -> void {
+    std::unique_lock lk(rw);
+    Node *update[MaxLevel];
+    Node *x{descend(searchKey, update)};
+    if (x && x->key == searchKey)
+      x->value = newValue;
+    else {
+      int lvl{randomLevel()};
+      if (lvl > level) {
+        for (int i = level; i < lvl; i++) update[i] = header;
+        level = lvl;
+      }
+      auto y{create(lvl, searchKey, newValue)};
+      for (int i = 0; i < lvl; i++) {
+        y->forward()[i] = update[i]->forward()[i];
+        update[i]->forward()[i] = y;
+      }
+    }
+  }
+
+  auto remove(K searchKey) -> void {
+    std::unique_lock lk(rw);
+    Node *update[MaxLevel];
+    Node *x{descend(searchKey, update)};
+    if (x && x->key == searchKey) {
+      for (int i = 0; i < x->top; i++)
+        update[i]->forward()[i] = x->forward()[i];
+      destroy(x);
+      while (level > 1 && header->forward()[level - 1] == nullptr) level--;
+    }
+  }
+
+  auto randomLevel() -> int {
+    int lvl{1};
+    while (lvl < MaxLevel && promote(mt)) lvl++;
+    return lvl;
+  }
+
+  auto printList() -> void {
+    for (auto e{header->forward()[0]}; e; e = e->forward()[0])
+      std::print("{}->{}\t", e->key, e->value);
+  }
+};
+
+// lock-free skip list (Herlihy & Shavit, Fraser)
+// the low bit of next[i] marks the node deleted at level i, the key is in
+// the set while next[0] is unmarked; find() unlinks marked nodes it passes
+// unlinked nodes are freed by epoch-based reclamation
+template <class K, class V, int MaxLevel = 16, int SLOTS = 128>
+  requires std::is_trivially_copyable_v<V>
+struct LockFreeSkipList {
+  using Link = std::atomic<std::uintptr_t>;
+  struct Node {
+    K key;
+    std::atomic<V> value;
+    int top;
+    // inserter and remover, whichever finishes last retires the node
+    std::atomic<int> owners{2};
+    Node *retired{nullptr};
+    Node(int top, K k, V v) : key{k}, value{v}, top{top} {}
+    // the tower of top links is allocated right behind the node
+    auto next() -> Link * { return reinterpret_cast<Link *>(this + 1); }
+  };
+
+  struct alignas(64) Slot {
+    std::atomic<bool> busy{false};
+    std::atomic<unsigned> epoch{0};
+  };
+
+  // a thread inside an operation holds a pinned slot
+  struct Guard {
+    LockFreeSkipList &list;
+    Slot *slot;
+    Guard(LockFreeSkipList &list) : list{list}, slot{list.pin()} {}
+    ~Guard() { slot->busy.store(false); }
+  };
+
+  Node *head;
+  std::atomic<unsigned> epoch{0};
+  Slot slots[SLOTS];
+  // nodes retired during epoch e wait in limbo[e % 3] until epoch e + 2
+  std::atomic<Node *> limbo[3]{};
+
+  LockFreeSkipList() : head{create(MaxLevel, K{}, V{})} {}
+
+  ~LockFreeSkipList() {
+    for (auto &bin : limbo) reclaim(bin.load());
+    while (head) {
+      Node *next{ptr(head->next()[0].load())};
+      destroy(head);
+      head = next;
+    }
+  }
+
+  static auto ptr(std::uintptr_t link) -> Node * {
+    return reinterpret_cast<Node *>(link & ~std::uintptr_t{1});
+  }
+  static auto marked(std::uintptr_t link) -> bool { return link & 1; }
+  static auto bits(Node *x) -> std::uintptr_t {
+    return reinterpret_cast<std::uintptr_t>(x);
+  }
+
+  static auto create(int top, K key, V value) -> Node * {
+    void *raw{operator new(sizeof(Node) + top * sizeof(Link))};
+    Node *x{new (raw) Node(top, key, value)};
+    for (int i = 0; i < top; i++) new (x->next() + i) Link(0);
+    return x;
+  }
+
+  static auto destroy(Node *x) -> void {
+    x->~Node();
+    operator delete(x);
+  }
+
+  auto search(K searchKey) -> std::optional<V> {
+    Guard g{*this};
+    Node *pred{head}, *curr{nullptr};
+    for (int i = MaxLevel - 1; i >= 0; i--) {
+      curr = ptr(pred->next()[i].load());
+      while (curr) {
+        std::uintptr_t succ{curr->next()[i].load()};
+        if (marked(succ))
+          curr = ptr(succ);
+        else if (curr->key < searchKey)
+          pred = curr, curr = ptr(succ);
+        else
+          break;
+      }
+    }
+    if (curr && curr->key == searchKey) return curr->value.load();
+    return std::nullopt;
+  }
+
+  auto insert(K searchKey, V newValue) -> void {
+    Guard g{*this};
+    Node *preds[MaxLevel], *succs[MaxLevel];
+    Node *x{nullptr};
+    while (true) {
+      if (find(searchKey, preds, succs)) {
+        succs[0]->value.store(newValue);
+        if (x) destroy(x);
+        return;
+      }
+      if (!x) x = create(randomLevel(), searchKey, newValue);
+      for (int i = 0; i < x->top; i++) x->next()[i].store(bits(succs[i]));
+      // linearization point
+      std::uintptr_t expected{bits(succs[0])};
+      if (preds[0]->next()[0].compare_exchange_strong(expected, bits(x)))
+        break;
+    }
+    link(x, preds, succs);
+    // a remover may have finished before the upper levels were linked
+    if (marked(x->next()[0].load())) find(searchKey, preds, succs);
+    release(x);
+  }
+
+  auto remove(K searchKey) -> void {
+    Guard g{*this};
+    Node *preds[MaxLevel], *succs[MaxLevel];
+    if (!find(searchKey, preds, succs)) return;
+    Node *victim{succs[0]};
+    for (int i = victim->top - 1; i > 0; i--) {
+      std::uintptr_t succ{victim->next()[i].load()};
+      while (!marked(succ))
+        victim->next()[i].compare_exchange_weak(succ, succ | 1);
+    }
+    std::uintptr_t succ{victim->next()[0].load()};
+    while (!marked(succ))
+      // linearization point
+      if (victim->next()[0].compare_exchange_weak(succ, succ | 1)) {
+        find(searchKey, preds, succs);
+        release(victim);
+        return;
+      }
+    // lost the race to another remover
+  }
+
+  // visit(key, value) for every key in [lo, hi) in ascending order; marked
+  // nodes are unlinked on the way rather than followed, the frozen link of
+  // a removed node can skip keys inserted after its removal
+  template <class Visit>
+  auto range(K lo, K hi, Visit visit) -> void {
+    Guard g{*this};
+    Node *preds[MaxLevel], *succs[MaxLevel];
+    find(lo, preds, succs);
+    Node *pred{preds[0]}, *curr{succs[0]};
+    while (curr && curr->key < hi) {
+      std::uintptr_t succ{curr->next()[0].load()};
+      if (marked(succ)) {
+        std::uintptr_t expected{bits(curr)};
+        if (pred->next()[0].compare_exchange_strong(expected, succ & ~1)) {
+          curr = ptr(succ);
+        } else {
+          // pred changed or went too, every key below curr is visited
+          find(curr->key, preds, succs);
+          pred = preds[0], curr = succs[0];
+        }
+        continue;
+      }
+      visit(curr->key, curr->value.load());
+      pred = curr, curr = ptr(succ);
+    }
+  }
+
+  // preds[i] < searchKey <= succs[i] at every level, unlinking marked nodes
+  // on the way, true if succs[0] holds searchKey
+  auto find(K searchKey, Node **preds, Node **succs) -> bool {
+    while (!traverse(searchKey, preds, succs)) {
+    }
+    return succs[0] && succs[0]->key == searchKey;
+  }
+
+  // false if an unlink lost a race and the search must restart
+  auto traverse(K searchKey, Node **preds, Node **succs) -> bool {
+    Node *pred{head};
+    for (int i = MaxLevel - 1; i >= 0; i--) {
+      Node *curr{ptr(pred->next()[i].load())};
+      while (curr) {
+        std::uintptr_t succ{curr->next()[i].load()};
+        if (marked(succ)) {
+          std::uintptr_t expected{bits(curr)};
+          if (!pred->next()[i].compare_exchange_strong(expected, succ & ~1))
+            return false;
+          curr = ptr(succ);
+        } else if (curr->key < searchKey) {
+          pred = curr;
+          curr = ptr(succ);
+        } else
+          break;
+      }
+      preds[i] = pred;
+      succs[i] = curr;
+    }
+    return true;
+  }
+
+  // link the levels above 0, giving up once x is being removed
+  auto link(Node *x, Node **preds, Node **succs) -> void {
+    for (int i = 1; i < x->top; i++)
+      while (true) {
+        std::uintptr_t next{x->next()[i].load()};
+        if (marked(next)) return;
+        if (ptr(next) != succs[i] &&
+            !x->next()[i].compare_exchange_strong(next, bits(succs[i])))
+          continue;
+        std::uintptr_t expected{bits(succs[i])};
+        if (preds[i]->next()[i].compare_exchange_strong(expected, bits(x)))
+          break;
+        find(x->key, preds, succs);
+        if (succs[0] != x) return;
+      }
+  }
+
+  auto randomLevel() -> int {
+    thread_local std::mt19937 mt(std::random_device{}());
+    int lvl{1};
+    while (mt() & 1 && lvl < MaxLevel) lvl++;
+    return lvl;
+  }
+
+  auto pin() -> Slot * {
+    std::size_t i{std::hash<std::thread::id>{}(std::this_thread::get_id())};
+    for (;; i++) {
+      Slot &slot{slots[i % SLOTS]};
+      bool idle{false};
+      if (!slot.busy.load() && slot.busy.compare_exchange_strong(idle, true)) {
+        slot.epoch.store(epoch.load());
+        return &slot;
+      }
+    }
+  }
+
+  auto release(Node *x) -> void {
+    if (x->owners.fetch_sub(1) == 1) retire(x);
+  }
+
+  auto retire(Node *x) -> void {
+    unsigned e{epoch.load()};
+    x->retired = limbo[e % 3].load();
+    while (!limbo[e % 3].compare_exchange_weak(x->retired, x)) {
+    }
+    // every pinned thread has seen e, nothing retired before e - 1 is
+    // reachable from any of them
+    for (const auto &slot : slots)
+      if (slot.busy.load() && slot.epoch.load() != e) return;
+    if (epoch.compare_exchange_strong(e, e + 1))
+      reclaim(limbo[(e + 2) % 3].exchange(nullptr));
+  }
+
+  static auto reclaim(Node *x) -> void {
+    while (x) {
+      Node *next{x->retired};
+      destroy(x);
+      x = next;
+    }
+  }
+};
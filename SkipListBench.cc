@@ -0,0 +1,54 @@
+// make SkipListBench CXXFLAGS="-std=c++23 -O2 -DNDEBUG"
+// the sanitizers replace operator new, so time without them
+// usage: SkipListBench.exe [keys]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+
+#include "SkipList.hh"
+
+std::atomic<long long> allocations{0};
+
+void *operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *p{std::malloc(size ? size : 1)}) return p;
+  std::abort();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+template <class List>
+void bench(const char *name, List &&list, const std::vector<int> &keys,
+           const std::vector<int> &order) {
+  auto run = [&](const char *op, auto f) {
+    long long before{allocations.load()};
+    auto start{std::chrono::steady_clock::now()};
+    for (int k : order) f(keys[k]);
+    std::chrono::duration<double, std::nano> elapsed{
+        std::chrono::steady_clock::now() - start};
+    std::print("{:<24}{:<8}{:>8.1f} ns/op{:>12} allocs\n", name, op,
+               elapsed.count() / order.size(), allocations.load() - before);
+  };
+  run("insert", [&](int k) { list.insert(k, k); });
+  long long found{0};
+  run("search", [&](int k) { found += list.search(k) != nullptr; });
+  assert(found == (long long)keys.size());
+  run("remove", [&](int k) { list.remove(k); });
+}
+
+int main(int argc, char *argv[]) {
+  int n{argc > 1 ? std::atoi(argv[1]) : 1 << 18};
+  std::mt19937 mt(std::random_device{}());
+  std::vector<int> keys(n), order(n);
+  for (int i = 0; i < n; i++) keys[i] = i, order[i] = i;
+  std::shuffle(keys.begin(), keys.end(), mt);
+  std::shuffle(order.begin(), order.end(), mt);
+
+  std::print("{} keys\n", n);
+  bench("SkipList", SkipList<int, int>{}, keys, order);
+  bench("SkipList MaxLevel 32", SkipList<int, int, std::mt19937, 32>{}, keys,
+        order);
+  bench("ArenaSkipList p 1/2", ArenaSkipList<int, int>{0.5}, keys, order);
+  bench("ArenaSkipList p 1/4", ArenaSkipList<int, int>{}, keys, order);
+}
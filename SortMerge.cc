@@ -1,7 +1,14 @@
 #include <algorithm>
+#include <barrier>
+#include <cassert>
 #include <concepts>
+#include <memory>
 #include <print>
 #include <random>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "vector.hh"
 
@@ -106,6 +113,163 @@ struct Merge408 {
   }
 };
 
+// chunks are sorted concurrently, then every thread co-ranks its share of
+// the output across all chunks and merges it; runs move between a and a
+// buffer of n elements, the last pass lands in a, nothing is copied back
+template <typename compar>
+  requires std::totally_ordered<compar>
+struct MergeParallel {
+  static constexpr std::size_t RUN{32}, GRAIN{1 << 14};
+
+  static int concurrency() {
+    return std::max(1, (int)std::thread::hardware_concurrency());
+  }
+
+  static void sort(ns::vector<compar> &a, int threads = concurrency()) {
+    sort(std::span<compar>(a.begin(), a.size()), threads);
+  }
+
+  static void sort(std::span<compar> a, int threads = concurrency()) {
+    std::size_t n{a.size()};
+    threads = (int)std::clamp<std::size_t>(n / GRAIN, 1, threads);
+    std::allocator<compar> alloc;
+    compar *buf{alloc.allocate(n)};
+    std::span<compar> b(buf, n);
+
+    auto chunk = [&](int t) {
+      return std::pair{n * t / threads, n * (t + 1) / threads};
+    };
+    // every chunk merges the same number of times so they agree on where
+    // the sorted runs end up, the buffer
+    std::size_t longest{chunk(0).second - chunk(0).first + 1}, passes{0};
+    for (std::size_t width = RUN; width < longest; width *= 2) passes++;
+    if (passes % 2) passes++;
+
+    std::vector<std::span<compar>> runs(threads);
+    std::barrier sync(threads);
+    auto worker = [&](int t) {
+      auto [lo, hi] = chunk(t);
+      std::uninitialized_move(a.begin() + lo, a.begin() + hi, b.begin() + lo);
+      sortChunk(b.subspan(lo, hi - lo), a.subspan(lo, hi - lo), passes);
+      runs[t] = b.subspan(lo, hi - lo);
+      sync.arrive_and_wait();
+
+      auto first{corank(runs, lo)}, last{corank(runs, hi)};
+      merge(runs, first, last, a.subspan(lo, hi - lo));
+      sync.arrive_and_wait();
+      std::destroy(b.begin() + lo, b.begin() + hi);
+    };
+    {
+      std::vector<std::jthread> pool;
+      for (int t = 1; t < threads; t++) pool.emplace_back(worker, t);
+      worker(0);
+    }
+    alloc.deallocate(buf, n);
+  }
+
+  // insertion sort runs of RUN, then bottom-up merges between src and dst,
+  // an even number of passes leaves the result in src
+  static void sortChunk(std::span<compar> src, std::span<compar> dst,
+                        std::size_t passes) {
+    std::size_t n{src.size()};
+    for (std::size_t lo = 0; lo < n; lo += RUN) {
+      std::size_t hi{std::min(lo + RUN, n)};
+      for (std::size_t i = lo + 1; i < hi; ++i) {
+        compar x{std::move(src[i])};
+        std::size_t j{i};
+        for (; j > lo && x < src[j - 1]; --j) src[j] = std::move(src[j - 1]);
+        src[j] = std::move(x);
+      }
+    }
+    std::size_t width{RUN};
+    for (std::size_t pass = 0; pass < passes; ++pass, width *= 2) {
+      for (std::size_t lo = 0; lo < n; lo += 2 * width) {
+        std::size_t mid{std::min(lo + width, n)};
+        std::size_t hi{std::min(lo + 2 * width, n)};
+        merge2(src.subspan(lo, mid - lo), src.subspan(mid, hi - mid),
+               dst.data() + lo);
+      }
+      std::swap(src, dst);
+    }
+  }
+
+  // ties go to the left run
+  static void merge2(std::span<compar> x, std::span<compar> y, compar *out) {
+    auto i{x.begin()}, j{y.begin()};
+    while (i != x.end() && j != y.end())
+      *out++ = *j < *i ? std::move(*j++) : std::move(*i++);
+    out = std::move(i, x.end(), out);
+    std::move(j, y.end(), out);
+  }
+
+  // splits[j] elements of run j come before output position p, ordering
+  // equal keys by run index; the p-th element is found by bisection in the
+  // one run that holds it
+  static std::vector<std::size_t> corank(
+      const std::vector<std::span<compar>> &runs, std::size_t p) {
+    int k = runs.size();
+    std::vector<std::size_t> splits(k);
+    auto place = [&](int c, std::size_t i) {
+      const compar &v{runs[c][i]};
+      std::size_t rank{i};
+      for (int j = 0; j < k; j++)
+        if (j < c)
+          rank += std::ranges::upper_bound(runs[j], v) - runs[j].begin();
+        else if (j > c)
+          rank += std::ranges::lower_bound(runs[j], v) - runs[j].begin();
+      return rank;
+    };
+    for (int c = 0; c < k; c++) {
+      std::size_t lo{0}, hi{runs[c].size()};
+      while (lo < hi) {
+        std::size_t mid{lo + (hi - lo) / 2};
+        if (place(c, mid) < p)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      if (lo < runs[c].size() && place(c, lo) == p) {
+        const compar &v{runs[c][lo]};
+        for (int j = 0; j < k; j++)
+          splits[j] =
+              j < c   ? std::ranges::upper_bound(runs[j], v) - runs[j].begin()
+              : j > c ? std::ranges::lower_bound(runs[j], v) - runs[j].begin()
+                      : lo;
+        return splits;
+      }
+    }
+    // p is past the last element
+    for (int j = 0; j < k; j++) splits[j] = runs[j].size();
+    return splits;
+  }
+
+  // k-way merge of runs[j][first[j], last[j]) through a binary heap of run
+  // indices ordered by their heads
+  static void merge(const std::vector<std::span<compar>> &runs,
+                    std::vector<std::size_t> first,
+                    const std::vector<std::size_t> &last,
+                    std::span<compar> out) {
+    auto later = [&](int x, int y) {
+      const compar &u{runs[x][first[x]]}, &v{runs[y][first[y]]};
+      return v < u || (!(u < v) && y < x);
+    };
+    std::vector<int> heap;
+    for (int j = 0; j < (int)runs.size(); j++)
+      if (first[j] < last[j]) heap.push_back(j);
+    std::ranges::make_heap(heap, later);
+    for (auto &x : out) {
+      std::ranges::pop_heap(heap, later);
+      int j{heap.back()};
+      x = std::move(runs[j][first[j]++]);
+      if (first[j] < last[j])
+        std::ranges::push_heap(heap, later);
+      else
+        heap.pop_back();
+    }
+    assert(heap.empty());
+  }
+};
+
 template <class S, class T>
 void printSort(ns::vector<T> A) {
   S::sort(A);
@@ -136,4 +300,25 @@ int main() {
   std::print("Merge408\n");
   printSort<Merge408<int>, int>(A);
   printSort<Merge408<int>, int>({4, 4, 4, 4});
-}
\ No newline at end of file
+
+  // equal keys keep their input order
+  struct Record {
+    int key, id;
+    bool operator==(const Record &rhs) const { return key == rhs.key; }
+    auto operator<=>(const Record &rhs) const { return key <=> rhs.key; }
+  };
+  for (int n : {0, 1, 100, 1 << 15, 1 << 18, 1 << 20})
+    for (int threads : {1, 3, 8}) {
+      std::uniform_int_distribution randKey(0, n / 64);
+      ns::vector<Record> R(n);
+      for (int i = 0; i < n; ++i) R[i] = {randKey(mt), i};
+      MergeParallel<Record>::sort(R, threads);
+      for (int i = 1; i < n; ++i)
+        assert(R[i - 1].key < R[i].key ||
+               (R[i - 1].key == R[i].key && R[i - 1].id < R[i].id));
+    }
+  std::vector<int> B(1 << 16);
+  for (auto &e : B) e = rand(mt);
+  MergeParallel<int>::sort(std::span(B).subspan(100, 1 << 15), 4);
+  assert(std::ranges::is_sorted(B.begin() + 100, B.begin() + 100 + (1 << 15)));
+}
@@ -1,9 +1,18 @@
 #include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cassert>
+#include <chrono>
 #include <concepts>
+#include <functional>
+#include <mutex>
 #include <print>
 #include <random>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#include "deque.hh"
 #include "vector.hh"
 
 template <typename compar>
@@ -127,6 +136,13 @@ struct Quick3way {
 
   static void sort(ns::vector<compar> &A, int lo, int hi) {
     if (lo >= hi) return;
+    auto [lt, gt] = partition(A, lo, hi);
+    sort(A, lo, lt - 1);
+    sort(A, gt + 1, hi);
+  }
+
+  // A[lt..gt] equal to the pivot A[lo]
+  static std::pair<int, int> partition(ns::vector<compar> &A, int lo, int hi) {
     int lt{lo}, gt{hi};
     compar pivot{A[lo]};
     int i{lo + 1};
@@ -138,8 +154,376 @@ struct Quick3way {
       else if (A[i] == pivot)
         ++i;
     }
-    sort(A, lo, lt - 1);
-    sort(A, gt + 1, hi);
+    return {lt, gt};
+  }
+};
+
+// pattern-defeating quicksort (Peters), introsort with
+// - median of 3, ninther above NINTHER elements
+// - branchless block partition (Edelkamp & Weiss) above 2 blocks,
+//   partition113 below
+// - insertion sort below INSERTION elements
+// - a range whose pivot equals the element left of it holds many
+//   duplicates, the 3-way partition sets them aside at once
+// - a partition that moved nothing hints at sorted input, a bounded
+//   insertion sort finishes it
+// - heapsort once log n partitions were badly unbalanced
+template <typename compar>
+  requires std::totally_ordered<compar>
+struct QuickHybrid {
+  static constexpr int INSERTION{24}, NINTHER{128}, BLOCK{64};
+
+  static void sort(ns::vector<compar> &A) {
+    if (A.size() < 2) return;
+    sort(A, 0, A.size() - 1, std::bit_width((unsigned)A.size()), true);
+  }
+
+  static void sort(ns::vector<compar> &A, int lo, int hi, int budget,
+                   bool leftmost) {
+    while (true) {
+      int n{hi - lo + 1};
+      if (n < INSERTION) {
+        insertion(A, lo, hi);
+        return;
+      }
+      choosePivot(A, lo, hi);
+      // A[lo - 1] <= A[lo..hi], nothing to the left of the pivot
+      if (!leftmost && !(A[lo - 1] < A[lo])) {
+        lo = Quick3way<compar>::partition(A, lo, hi).second + 1;
+        if (lo >= hi) return;
+        continue;
+      }
+
+      auto [p, partitioned] = n >= 2 * BLOCK
+                                  ? partitionBlock(A, lo, hi)
+                                  : std::pair{Quick226<compar>::partition113(
+                                                  A, lo, hi),
+                                              false};
+      int l{p - lo}, r{hi - p};
+      if (l < n / 8 || r < n / 8) {
+        if (--budget == 0) {
+          std::make_heap(A.begin() + lo, A.begin() + hi + 1);
+          std::sort_heap(A.begin() + lo, A.begin() + hi + 1);
+          return;
+        }
+        breakPatterns(A, lo, p - 1);
+        breakPatterns(A, p + 1, hi);
+      } else if (partitioned && partialInsertion(A, lo, p - 1) &&
+                 partialInsertion(A, p + 1, hi))
+        return;
+
+      // recurse into the smaller side, loop on the larger
+      if (l < r) {
+        sort(A, lo, p - 1, budget, leftmost);
+        lo = p + 1;
+        leftmost = false;
+      } else {
+        sort(A, p + 1, hi, budget, false);
+        hi = p - 1;
+      }
+    }
+  }
+
+  static void sort3(ns::vector<compar> &A, int a, int b, int c) {
+    if (A[b] < A[a]) std::swap(A[a], A[b]);
+    if (A[c] < A[b]) std::swap(A[b], A[c]);
+    if (A[b] < A[a]) std::swap(A[a], A[b]);
+  }
+
+  // the median goes to A[lo], some A[k] >= A[lo] remains right of it
+  static void choosePivot(ns::vector<compar> &A, int lo, int hi) {
+    int mid{lo + (hi - lo) / 2};
+    sort3(A, lo, mid, hi);
+    if (hi - lo + 1 > NINTHER) {
+      sort3(A, lo + 1, mid - 1, hi - 1);
+      sort3(A, lo + 2, mid + 1, hi - 2);
+      sort3(A, mid - 1, mid, mid + 1);
+    }
+    std::swap(A[lo], A[mid]);
+  }
+
+  static void insertion(ns::vector<compar> &A, int lo, int hi) {
+    for (int i = lo + 1; i <= hi; ++i) {
+      compar x{std::move(A[i])};
+      int j{i};
+      for (; j > lo && x < A[j - 1]; --j) A[j] = std::move(A[j - 1]);
+      A[j] = std::move(x);
+    }
+  }
+
+  // gives up after a few moves, the range was not nearly sorted
+  static bool partialInsertion(ns::vector<compar> &A, int lo, int hi) {
+    int moves{0};
+    for (int i = lo + 1; i <= hi; ++i) {
+      if (!(A[i] < A[i - 1])) continue;
+      compar x{std::move(A[i])};
+      int j{i};
+      for (; j > lo && x < A[j - 1]; --j) A[j] = std::move(A[j - 1]);
+      A[j] = std::move(x);
+      moves += i - j;
+      if (moves > 8) return false;
+    }
+    return true;
+  }
+
+  static void breakPatterns(ns::vector<compar> &A, int lo, int hi) {
+    int n{hi - lo + 1};
+    if (n < INSERTION) return;
+    std::swap(A[lo], A[lo + n / 4]);
+    std::swap(A[hi], A[hi - n / 4]);
+    if (n > NINTHER) {
+      std::swap(A[lo + 1], A[lo + n / 4 + 1]);
+      std::swap(A[lo + 2], A[lo + n / 4 + 2]);
+      std::swap(A[hi - 1], A[hi - n / 4 - 1]);
+      std::swap(A[hi - 2], A[hi - n / 4 - 2]);
+    }
+  }
+
+  // elements equal to the pivot A[lo] go right; the scans fill blocks of
+  // offsets of misplaced elements without branching, then swap them in
+  // pairs; also reports whether nothing had to move
+  static std::pair<int, bool> partitionBlock(ns::vector<compar> &A, int lo,
+                                             int hi) {
+    compar *begin{A.begin() + lo}, *first{begin}, *last{A.begin() + hi + 1};
+    compar pivot{std::move(*begin)};
+    while (*++first < pivot) {
+    }
+    if (first - 1 == begin)
+      while (first < last && !(*--last < pivot)) {
+      }
+    else
+      while (!(*--last < pivot)) {
+      }
+    bool partitioned{first >= last};
+
+    if (!partitioned) {
+      std::swap(*first++, *last);
+      alignas(64) unsigned char offsetsL[BLOCK], offsetsR[BLOCK];
+      compar *baseL{first}, *baseR{last};
+      int numL{0}, numR{0}, startL{0}, startR{0};
+      while (first < last) {
+        int unknown = last - first;
+        int splitL{numL == 0 ? (numR == 0 ? unknown / 2 : unknown) : 0};
+        int splitR{numR == 0 ? unknown - splitL : 0};
+        for (int i = 0; i < std::min(splitL, (int)BLOCK); ++i) {
+          offsetsL[numL] = i;
+          numL += !(*first++ < pivot);
+        }
+        for (int i = 0; i < std::min(splitR, (int)BLOCK);) {
+          offsetsR[numR] = ++i;
+          numR += *--last < pivot;
+        }
+        int num{std::min(numL, numR)};
+        for (int i = 0; i < num; ++i)
+          std::swap(baseL[offsetsL[startL + i]],
+                    *(baseR - offsetsR[startR + i]));
+        numL -= num, numR -= num;
+        startL += num, startR += num;
+        if (numL == 0) startL = 0, baseL = first;
+        if (numR == 0) startR = 0, baseR = last;
+      }
+      // one block may still hold misplaced elements
+      if (numL) {
+        while (numL--) std::swap(baseL[offsetsL[startL + numL]], *--last);
+        first = last;
+      }
+      if (numR) {
+        while (numR--) std::swap(*(baseR - offsetsR[startR + numR]), *first++);
+        last = first;
+      }
+    }
+
+    compar *pos{first - 1};
+    *begin = std::move(*pos);
+    *pos = std::move(pivot);
+    return {(int)(pos - A.begin()), partitioned};
+  }
+};
+
+// subranges become tasks on per-thread deques, an idle thread steals the
+// oldest, largest, task of another; ranges below CUTOFF are left to
+// QuickHybrid and ranges above SPLIT are partitioned in blocks, which are
+// tasks of the same pool
+template <typename compar>
+  requires std::totally_ordered<compar>
+struct QuickParallel {
+  static constexpr int CUTOFF{1 << 13}, SPLIT{1 << 20};
+
+  // blocks of one parallel partition step, left counts those unfinished
+  struct Blocks {
+    std::function<void(int)> f;
+    std::atomic<int> left;
+  };
+  // a subrange to sort, or block lo of blocks
+  struct Task {
+    int lo, hi;
+    bool leftmost;
+    Blocks *blocks{nullptr};
+  };
+  struct alignas(64) Worker {
+    std::mutex m;
+    ns::deque<Task> tasks;
+  };
+
+  ns::vector<compar> &A;
+  int threads;
+  std::vector<Worker> workers;
+  // tasks pushed and not yet finished
+  std::atomic<int> pending{0};
+
+  static int concurrency() {
+    return std::max(1, (int)std::thread::hardware_concurrency());
+  }
+
+  static void sort(ns::vector<compar> &A, int threads = concurrency()) {
+    if (A.size() < 2) return;
+    QuickParallel q(A, threads);
+    q.push(0, {0, A.size() - 1, true});
+    std::vector<std::jthread> pool;
+    for (int t = 1; t < threads; t++)
+      pool.emplace_back(&QuickParallel::run, &q, t);
+    q.run(0);
+  }
+
+  QuickParallel(ns::vector<compar> &A, int threads)
+      : A{A}, threads{threads}, workers(threads) {}
+
+  void push(int t, Task task) {
+    pending++;
+    std::lock_guard lk(workers[t].m);
+    workers[t].tasks.push_back(task);
+  }
+
+  // own tasks newest first, stolen ones oldest first
+  bool pop(int t, Task &task) {
+    for (int i = 0; i < threads; i++) {
+      Worker &w{workers[(t + i) % threads]};
+      std::lock_guard lk(w.m);
+      if (w.tasks.empty()) continue;
+      if (i == 0)
+        task = w.tasks.back(), w.tasks.pop_back();
+      else
+        task = w.tasks.front(), w.tasks.pop_front();
+      return true;
+    }
+    return false;
+  }
+
+  void run(int t) {
+    Task task;
+    while (pending.load() > 0)
+      if (pop(t, task)) {
+        process(t, task);
+        pending--;
+      } else
+        std::this_thread::yield();
+  }
+
+  void process(int t, Task task) {
+    if (task.blocks) {
+      task.blocks->f(task.lo);
+      task.blocks->left--;
+      return;
+    }
+    auto [lo, hi, leftmost, _] = task;
+    while (hi - lo + 1 >= CUTOFF) {
+      QuickHybrid<compar>::choosePivot(A, lo, hi);
+      // duplicates of the left neighbour are already in place
+      if (!leftmost && !(A[lo - 1] < A[lo])) {
+        const compar &pivot{A[lo - 1]};
+        lo += partition(t, lo, hi,
+                        [&](const compar &x) { return !(pivot < x); });
+        if (lo >= hi) return;
+        continue;
+      }
+      int p;
+      if (hi - lo + 1 >= SPLIT) {
+        const compar &pivot{A[lo]};
+        p = lo + partition(t, lo + 1, hi,
+                           [&](const compar &x) { return x < pivot; });
+        std::swap(A[lo], A[p]);
+      } else
+        p = QuickHybrid<compar>::partitionBlock(A, lo, hi).first;
+      // the larger side is offered to thieves
+      if (p - lo > hi - p) {
+        push(t, {lo, p - 1, leftmost});
+        lo = p + 1, leftmost = false;
+      } else {
+        push(t, {p + 1, hi, false});
+        hi = p - 1;
+      }
+    }
+    if (lo < hi)
+      QuickHybrid<compar>::sort(A, lo, hi, std::bit_width((unsigned)(hi - lo)),
+                                leftmost);
+  }
+
+  // runs f(0) .. f(k - 1) as tasks of the pool; worker t takes f(0) and,
+  // until all are done, any other task, so waiting never idles a thread
+  void parallel(int t, int k, std::function<void(int)> f) {
+    Blocks blocks{std::move(f), k};
+    for (int c = 1; c < k; c++) push(t, {c, 0, false, &blocks});
+    process(t, {0, 0, false, &blocks});
+    Task task;
+    while (blocks.left.load() > 0)
+      if (pop(t, task)) {
+        process(t, task);
+        pending--;
+      } else
+        std::this_thread::yield();
+  }
+
+  // parallel in-place partition of A[lo..hi], returns the count of x with
+  // left(x); each chunk is partitioned on its own, then the right-side
+  // elements left of the boundary are swapped with the left-side elements
+  // right of it, split evenly among the blocks
+  template <class Pred>
+  int partition(int t, int lo, int hi, Pred left) {
+    int n{hi - lo + 1};
+    int k = std::clamp<long long>((long long)threads * n / A.size(), 1,
+                                  threads);
+    std::vector<int> split(k);
+    auto chunk = [&](int c) {
+      return std::pair{lo + (int)((long long)n * c / k),
+                       lo + (int)((long long)n * (c + 1) / k)};
+    };
+    parallel(t, k, [&](int c) {
+      auto [b, e] = chunk(c);
+      split[c] = std::partition(A.begin() + b, A.begin() + e, left) - A.begin();
+    });
+
+    int less{0};
+    for (int c = 0; c < k; c++) less += split[c] - chunk(c).first;
+    int boundary{lo + less};
+    // misplaced intervals on each side, with running lengths
+    std::vector<std::pair<int, int>> wrongL, wrongR;
+    std::vector<int> sumL{0}, sumR{0};
+    for (int c = 0; c < k; c++) {
+      auto [b, e] = chunk(c);
+      if (split[c] < std::min(e, boundary)) {
+        wrongL.push_back({split[c], std::min(e, boundary)});
+        sumL.push_back(sumL.back() + wrongL.back().second - split[c]);
+      }
+      if (std::max(b, boundary) < split[c]) {
+        wrongR.push_back({std::max(b, boundary), split[c]});
+        sumR.push_back(sumR.back() + split[c] - wrongR.back().first);
+      }
+    }
+    int m{sumL.back()};
+    assert(m == sumR.back());
+    // the i-th misplaced position among the intervals
+    auto at = [](const auto &wrong, const auto &sum, int i, int &j) {
+      while (sum[j + 1] <= i) j++;
+      return wrong[j].first + i - sum[j];
+    };
+    parallel(t, k, [&](int c) {
+      int first = (long long)m * c / k, last = (long long)m * (c + 1) / k;
+      int jl = std::ranges::upper_bound(sumL, first) - sumL.begin() - 1;
+      int jr = std::ranges::upper_bound(sumR, first) - sumR.begin() - 1;
+      for (int i = first; i < last; i++)
+        std::swap(A[at(wrongL, sumL, i, jl)], A[at(wrongR, sumR, i, jr)]);
+    });
+    return less;
   }
 };
 
@@ -169,4 +553,59 @@ int main() {
   std::print("Quick408\n");
   printSort<Quick408<int>, int>(A);
   printSort<Quick408<int>, int>({4, 4, 4, 4});
-}
\ No newline at end of file
+
+  std::print("QuickHybrid\n");
+  printSort<QuickHybrid<int>, int>(A);
+  printSort<QuickHybrid<int>, int>({4, 4, 4, 4});
+
+  // patterns that defeat a plain quicksort
+  std::vector<std::function<int(int, int)>> patterns{
+      [&](int, int) { return (int)mt(); },
+      [](int i, int) { return i; },
+      [](int i, int n) { return n - i; },
+      [](int i, int n) { return i < n / 2 ? i : n - i; },
+      [](int i, int) { return i % 16; },
+      [](int, int) { return 7; },
+      [&](int i, int n) { return mt() % 64 ? i : n - i; },
+      [](int i, int) { return i % 2 ? i : -i; },
+  };
+  for (const auto &pattern : patterns)
+    for (int n : {0, 1, 2, 23, 24, 100, 128, 129, 1000, 100000}) {
+      ns::vector<int> B(n);
+      for (int i = 0; i < n; ++i) B[i] = pattern(i, n);
+      std::vector<int> C(B.begin(), B.end());
+      QuickHybrid<int>::sort(B);
+      std::ranges::sort(C);
+      assert(std::ranges::equal(B, C));
+    }
+
+  // against Quick3way on inputs large enough to split in parallel
+  auto millis = [](auto f) {
+    auto start{std::chrono::steady_clock::now()};
+    f();
+    std::chrono::duration<double, std::milli> elapsed{
+        std::chrono::steady_clock::now() - start};
+    return elapsed.count();
+  };
+  std::pair<const char *, std::function<int(int, int)>> inputs[]{
+      {"random", patterns[0]},
+      {"sorted", patterns[1]},
+      {"reversed", patterns[2]},
+      {"few unique", patterns[4]},
+  };
+  int n{QuickParallel<int>::SPLIT * 2};
+  for (const auto &[name, pattern] : inputs) {
+    ns::vector<int> B(n);
+    for (int i = 0; i < n; ++i) B[i] = pattern(i, n);
+    ns::vector<int> C{B};
+    double parallel{millis([&] { QuickParallel<int>::sort(B); })};
+    double serial{millis([&] { Quick3way<int>::sort(C); })};
+    assert(std::ranges::equal(B, C));
+    std::print("{}\tQuickParallel {:.1f} ms\tQuick3way {:.1f} ms\n", name,
+               parallel, serial);
+  }
+  ns::vector<int> D(n);
+  for (int i = 0; i < n; ++i) D[i] = patterns[7](i, n);
+  QuickParallel<int>::sort(D, 3);
+  assert(std::ranges::is_sorted(D));
+}
@@ -1,6 +1,16 @@
+#include <algorithm>
+#include <array>
+#include <barrier>
+#include <bit>
+#include <cassert>
 #include <concepts>
+#include <cstdint>
+#include <functional>
 #include <print>
 #include <random>
+#include <span>
+#include <thread>
+#include <vector>
 
 #include "vector.hh"
 
@@ -15,9 +25,10 @@ void LSD(ns::vector<T> &A) {
 
   int n = A.size();
   ns::vector<T> aux(n);
+  ns::vector<int> count(R + 1, 0);
 
   for (int d = 0; d < BYTES; d++) {
-    ns::vector<int> count(R + 1, 0);
+    std::ranges::fill(count, 0);
     for (int i = 0; i < n; i++) {
       int c = (A[i] >> BITS_PER_BYTE * d) & MASK;
       count[c + 1]++;
@@ -41,13 +52,173 @@ void LSD(ns::vector<T> &A) {
       aux[count[c]++] = A[i];
     }
     std::swap(A, aux);
+  }
+}
 
-    std::print("\n");
-    std::ranges::for_each(A, [](auto x) { std::print("{}\t", x); });
-    std::print("\n");
+// order preserving map to unsigned, signed integers flip the sign bit,
+// negative floats flip every bit and positive ones the sign bit
+template <class K>
+  requires std::integral<K> || std::floating_point<K>
+auto radixKey(K k) {
+  if constexpr (std::floating_point<K>) {
+    using U = std::conditional_t<sizeof(K) == 4, std::uint32_t, std::uint64_t>;
+    U u{std::bit_cast<U>(k)}, sign{U{1} << (sizeof(U) * 8 - 1)};
+    return u & sign ? U(~u) : U(u | sign);
+  } else {
+    using U = std::make_unsigned_t<K>;
+    U u = k;
+    if constexpr (std::is_signed_v<K>) u ^= U{1} << (sizeof(U) * 8 - 1);
+    return u;
   }
 }
 
+inline int concurrency() {
+  return std::max(1, (int)std::thread::hardware_concurrency());
+}
+
+template <class T, class Key>
+concept radixSortable = requires(const T &x, Key key) {
+  radixKey(std::invoke(key, x));
+};
+
+// stable LSD with 11-bit digits, every thread counts and scatters its own
+// chunk so that the per-thread prefix sums keep equal digits in order; a
+// pass is skipped when all keys share its digit
+template <class T, class Key = std::identity>
+  requires radixSortable<T, Key>
+void ParallelLSD(std::span<T> A, Key key = {},
+                 int threads = concurrency()) {
+  constexpr int BITS = 11, R = 1 << BITS, GRAIN = 1 << 16;
+  using U = decltype(radixKey(std::invoke(key, A[0])));
+  constexpr int DIGITS = (sizeof(U) * 8 + BITS - 1) / BITS;
+  auto digit = [&](const T &x, int d) -> int {
+    return radixKey(std::invoke(key, x)) >> BITS * d & (R - 1);
+  };
+
+  std::size_t n{A.size()};
+  threads = (int)std::clamp<std::size_t>(n / GRAIN, 1, threads);
+  auto chunk = [&](int t) {
+    return std::pair{n * t / threads, n * (t + 1) / threads};
+  };
+  using Histogram = std::array<std::size_t, R>;
+  std::vector<std::array<Histogram, DIGITS>> local(threads);
+  std::vector<T> aux(A.begin(), A.end());
+  std::span<T> src{A}, dst{aux};
+  int d{-1};
+  bool moved{false};
+
+  // picks the next pass, the buffers swap after a pass
+  std::array<bool, DIGITS> skip{};
+  auto next = [&]() noexcept {
+    if (d >= 0) std::swap(src, dst), moved = !moved;
+    do d++;
+    while (d < DIGITS && skip[d]);
+  };
+  // one counting pass finds the digits worth sorting on
+  auto plan = [&]() noexcept {
+    for (int i = 0; i < DIGITS; i++)
+      for (int r = 0; r < R; r++) {
+        std::size_t total{0};
+        for (const auto &h : local) total += h[i][r];
+        if (total == n) skip[i] = true;
+      }
+    next();
+  };
+  std::barrier planned(threads, plan), scattered(threads, next);
+  std::barrier counted(threads);
+
+  auto worker = [&](int t) {
+    auto [lo, hi] = chunk(t);
+    auto &h{local[t]};
+    for (auto &digits : h) digits.fill(0);
+    for (std::size_t i = lo; i < hi; i++)
+      for (int j = 0; j < DIGITS; j++) h[j][digit(A[i], j)]++;
+    planned.arrive_and_wait();
+    while (d < DIGITS) {
+      Histogram &own{h[0]};
+      own.fill(0);
+      for (std::size_t i = lo; i < hi; i++) own[digit(src[i], d)]++;
+      counted.arrive_and_wait();
+      // keys with a smaller digit, or the same digit in an earlier chunk
+      Histogram offset{};
+      std::size_t base{0};
+      for (int r = 0; r < R; r++) {
+        offset[r] = base;
+        for (int u = 0; u < threads; u++) {
+          if (u == t) offset[r] = base;
+          base += local[u][0][r];
+        }
+      }
+      for (std::size_t i = lo; i < hi; i++)
+        dst[offset[digit(src[i], d)]++] = std::move(src[i]);
+      scattered.arrive_and_wait();
+    }
+    if (moved) std::move(aux.begin() + lo, aux.begin() + hi, A.begin() + lo);
+  };
+  {
+    std::vector<std::jthread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(worker, t);
+    worker(0);
+  }
+}
+
+template <class T, class Key = std::identity>
+  requires radixSortable<T, Key>
+void ParallelLSD(ns::vector<T> &A, Key key = {},
+                 int threads = concurrency()) {
+  ParallelLSD(std::span<T>(A.begin(), A.size()), key, threads);
+}
+
+// in-place MSD (American flag sort), 8-bit digits from the top, elements
+// are cycled into their buckets; not stable
+template <class T, class Key = std::identity>
+  requires radixSortable<T, Key>
+void AmericanFlag(std::span<T> A, Key key = {}) {
+  constexpr int BITS = 8, R = 1 << BITS, CUTOFF = 32;
+  using U = decltype(radixKey(std::invoke(key, A[0])));
+  auto radix = [&](const T &x) { return radixKey(std::invoke(key, x)); };
+
+  auto sort = [&](auto &self, std::span<T> a, int shift) -> void {
+    if (a.size() < CUTOFF) {
+      for (std::size_t i = 1; i < a.size(); i++)
+        for (std::size_t j = i; j > 0 && radix(a[j]) < radix(a[j - 1]); j--)
+          std::swap(a[j], a[j - 1]);
+      return;
+    }
+    auto digit = [&](const T &x) -> int { return radix(x) >> shift & (R - 1); };
+    std::array<std::size_t, R> count{}, next, end;
+    for (const auto &x : a) count[digit(x)]++;
+    // every key shares this digit
+    if (std::ranges::find(count, a.size()) != count.end()) {
+      if (shift > 0) self(self, a, shift - BITS);
+      return;
+    }
+    std::size_t base{0};
+    for (int r = 0; r < R; r++) {
+      next[r] = base;
+      end[r] = base += count[r];
+    }
+    for (int r = 0; r < R; r++)
+      while (next[r] < end[r]) {
+        T x{std::move(a[next[r]])};
+        for (int c = digit(x); c != r; c = digit(x))
+          std::swap(x, a[next[c]++]);
+        a[next[r]++] = std::move(x);
+      }
+    if (shift == 0) return;
+    std::size_t lo{0};
+    for (int r = 0; r < R; lo += count[r++])
+      if (count[r] > 1) self(self, a.subspan(lo, count[r]), shift - BITS);
+  };
+  if (!A.empty()) sort(sort, A, sizeof(U) * 8 - BITS);
+}
+
+template <class T, class Key = std::identity>
+  requires radixSortable<T, Key>
+void AmericanFlag(ns::vector<T> &A, Key key = {}) {
+  AmericanFlag(std::span<T>(A.begin(), A.size()), key);
+}
+
 int main() {
   std::mt19937 mt(std::random_device{}());
   std::uniform_int_distribution<int> rand(0x80000000, 0x7fffffff);
@@ -65,4 +236,37 @@ int main() {
   std::print("\n\n");
   std::print("{}", std::ranges::is_sorted(A) ? "Sorted" : "Unsorted");
   std::print("\n");
-}
\ No newline at end of file
+
+  for (int n : {0, 1, 31, 1000, 1 << 17, 1 << 20})
+    for (int threads : {1, 3, 8}) {
+      std::vector<int> B(n);
+      for (auto &e : B) e = rand(mt);
+      auto C{B};
+      ParallelLSD(std::span(B), std::identity{}, threads);
+      AmericanFlag(std::span(C));
+      assert(std::ranges::is_sorted(B) && std::ranges::is_sorted(C));
+      // only the low 11 bits differ, every other pass is skipped
+      std::vector<std::uint64_t> D(n);
+      for (auto &e : D) e = 0xabcd'0000'0000'0000 | (rand(mt) & 0x7ff);
+      ParallelLSD(std::span(D), std::identity{}, threads);
+      assert(std::ranges::is_sorted(D));
+    }
+
+  // records by a float field, equal keys keep their order
+  struct Record {
+    float score;
+    int id;
+  };
+  std::uniform_real_distribution<float> randF(-8, 8);
+  ns::vector<Record> E(1 << 18);
+  for (int i = 0; i < E.size(); i++) E[i] = {(int)randF(mt) / 2.0f, i};
+  E[0].score = -0.0f, E[1].score = 1e30f, E[2].score = -1e-30f;
+  auto F{E};
+  ParallelLSD(E, &Record::score, 4);
+  for (int i = 1; i < E.size(); i++)
+    assert(E[i - 1].score < E[i].score ||
+           (E[i - 1].score == E[i].score && E[i - 1].id < E[i].id) ||
+           (E[i].score == 0 && E[i - 1].score == 0));
+  AmericanFlag(F, &Record::score);
+  assert(std::ranges::is_sorted(F, {}, &Record::score));
+}
@@ -1,6 +1,19 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <print>
+#include <random>
+#include <span>
+#include <string>
 #include <string_view>
 #include <vector>
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SUBSTR_SIMD 1
+#include <immintrin.h>
+#endif
 
 int naiveMethod(std::string_view pat, std::string_view txt) {
   int M = pat.size();
@@ -88,7 +101,7 @@ struct BM {
   static std::vector<int> right(std::string_view pat) {
     std::vector<int> right(256);
     for (int c = 0; c < 256; c++) right[c] = -1;
-    for (int j = 0; j < pat.size(); j++) right[pat[j]] = j;
+    for (int j = 0; j < (int)pat.size(); j++) right[(unsigned char)pat[j]] = j;
     return right;
   }
 
@@ -101,7 +114,7 @@ struct BM {
       skip = 0;
       for (int j = M - 1; j >= 0; j--) {
         if (pat.at(j) != txt.at(i + j)) {
-          skip = std::max(1, j - A[txt.at(i + j)]);
+          skip = std::max(1, j - A[(unsigned char)txt.at(i + j)]);
           break;
         }
       }
@@ -111,6 +124,327 @@ struct BM {
   }
 };
 
+// streaming matchers: text arrives in chunks of any size, matches are
+// reported at absolute offsets from the start of the stream
+
+// the KMP automaton state j, the length of the matched prefix, carries
+// over from one chunk to the next; the table extends to j == m so that
+// overlapping matches continue after a full one
+struct StreamKMP {
+  std::string pat;
+  std::vector<int> N;
+  int j{0};
+  long long offset{0};
+
+  explicit StreamKMP(std::string_view pat) : pat{pat}, N(pat.size() + 1) {
+    assert(!pat.empty());
+    int m = pat.size(), k = 0;
+    int t = N[0] = -1;
+    while (k < m)
+      if (t < 0 || pat[k] == pat[t])
+        N[++k] = ++t;
+      else
+        t = N[t];
+  }
+
+  template <class Visit>
+  void feed(std::string_view chunk, Visit visit) {
+    int m = pat.size();
+    for (int i = 0; i < (int)chunk.size();) {
+      if (j < 0 || (j < m && chunk[i] == pat[j]))
+        ++i, ++j;
+      else
+        j = N[j];
+      if (j == m) {
+        visit(offset + i - m);
+        j = N[m];
+      }
+    }
+    offset += chunk.size();
+  }
+
+  std::vector<long long> feed(std::string_view chunk) {
+    std::vector<long long> found;
+    feed(chunk, [&](long long at) { found.push_back(at); });
+    return found;
+  }
+};
+
+// BM needs the m bytes under the window, the last m - 1 bytes seen are
+// kept; a chunk is searched in place, only the seam with the kept bytes
+// is copied
+struct StreamBM {
+  std::string pat, carry;
+  std::vector<int> right;
+  long long offset{0};
+
+  explicit StreamBM(std::string_view pat) : pat{pat}, right(BM::right(pat)) {
+    assert(!pat.empty());
+  }
+
+  // every i < limit with txt[i, i + m) == pat
+  template <class Visit>
+  void search(std::string_view txt, int limit, Visit visit) const {
+    int N = txt.size(), M = pat.size();
+    for (int i = 0, skip; i <= N - M && i < limit; i += skip) {
+      skip = 0;
+      for (int j = M - 1; j >= 0; j--)
+        if (pat[j] != txt[i + j]) {
+          skip = std::max(1, j - right[(unsigned char)txt[i + j]]);
+          break;
+        }
+      if (skip == 0) visit(i), skip = 1;
+    }
+  }
+
+  template <class Visit>
+  void feed(std::string_view chunk, Visit visit) {
+    int m = pat.size(), kept = carry.size();
+    // matches that start in the kept bytes
+    std::string seam{carry};
+    seam.append(chunk.substr(0, m - 1));
+    search(seam, kept, [&](int i) { visit(offset - kept + i); });
+    search(chunk, chunk.size(), [&](int i) { visit(offset + i); });
+    offset += chunk.size();
+    if ((int)chunk.size() >= m - 1)
+      carry = chunk.substr(chunk.size() - (m - 1));
+    else {
+      carry.append(chunk);
+      carry.erase(0, carry.size() - std::min<int>(carry.size(), m - 1));
+    }
+  }
+
+  std::vector<long long> feed(std::string_view chunk) {
+    std::vector<long long> found;
+    feed(chunk, [&](long long at) { found.push_back(at); });
+    return found;
+  }
+};
+
+// a pattern compiled once and matched against many texts, every
+// occurrence is reported, overlapping ones too
+// short patterns: candidates are positions whose first and last bytes
+// both match, found 16 or 32 at a time with SIMD compares
+// long patterns: Horspool, the shift is looked up by the text byte under
+// the pattern's last position
+struct CompiledPattern {
+  static constexpr int SHORT{32};
+  std::string pat;
+  std::array<std::size_t, 256> shift;
+
+  explicit CompiledPattern(std::string_view pat) : pat{pat} {
+    assert(!pat.empty());
+    std::size_t m{pat.size()};
+    shift.fill(m);
+    for (std::size_t j = 0; j + 1 < m; j++)
+      shift[(unsigned char)pat[j]] = m - 1 - j;
+  }
+
+  // offsets are std::size_t throughout, texts may pass 2 GiB
+  std::vector<std::size_t> search(std::string_view txt) const {
+    std::vector<std::size_t> found;
+    scan(txt, [&](std::size_t i) { found.push_back(i); });
+    return found;
+  }
+
+  template <class Visit>
+  void scan(std::string_view txt, Visit visit) const {
+    if (txt.size() < pat.size()) return;
+    if (pat.size() > SHORT) return horspool(txt, visit);
+#if SUBSTR_SIMD
+    static const bool avx2{[] {
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2") != 0;
+    }()};
+    std::size_t i{avx2 ? filterAVX2(txt, visit) : filterSSE2(txt, visit)};
+#else
+    std::size_t i{0};
+#endif
+    for (std::size_t last = txt.size() - pat.size(); i <= last; i++)
+      if (txt.compare(i, pat.size(), pat) == 0) visit(i);
+  }
+
+  bool middle(std::string_view txt, std::size_t j) const {
+    std::size_t m{pat.size()};
+    return m <= 2 ||
+           std::memcmp(txt.data() + j + 1, pat.data() + 1, m - 2) == 0;
+  }
+
+  template <class Visit>
+  void horspool(std::string_view txt, Visit visit) const {
+    std::size_t m{pat.size()}, n{txt.size()};
+    for (std::size_t i = 0; i + m <= n;
+         i += shift[(unsigned char)txt[i + m - 1]])
+      if (txt[i + m - 1] == pat[m - 1] &&
+          std::memcmp(txt.data() + i, pat.data(), m - 1) == 0)
+        visit(i);
+  }
+
+#if SUBSTR_SIMD
+  // candidates in the block at i, the bytes strictly between the first and
+  // the last still need comparing; returns where the scalar tail starts
+  template <class Visit>
+  [[gnu::target("avx2")]] std::size_t filterAVX2(std::string_view txt,
+                                                 Visit visit) const {
+    std::size_t m{pat.size()}, n{txt.size()}, i{0};
+    __m256i first{_mm256_set1_epi8(pat.front())};
+    __m256i last{_mm256_set1_epi8(pat.back())};
+    for (; i + m - 1 + 32 <= n; i += 32) {
+      auto head{_mm256_loadu_si256((const __m256i *)(txt.data() + i))};
+      auto tail{
+          _mm256_loadu_si256((const __m256i *)(txt.data() + i + m - 1))};
+      unsigned mask = _mm256_movemask_epi8(_mm256_and_si256(
+          _mm256_cmpeq_epi8(head, first), _mm256_cmpeq_epi8(tail, last)));
+      for (; mask; mask &= mask - 1) {
+        std::size_t j = i + std::countr_zero(mask);
+        if (middle(txt, j)) visit(j);
+      }
+    }
+    return i;
+  }
+
+  template <class Visit>
+  std::size_t filterSSE2(std::string_view txt, Visit visit) const {
+    std::size_t m{pat.size()}, n{txt.size()}, i{0};
+    __m128i first{_mm_set1_epi8(pat.front())}, last{_mm_set1_epi8(pat.back())};
+    for (; i + m - 1 + 16 <= n; i += 16) {
+      auto head{_mm_loadu_si128((const __m128i *)(txt.data() + i))};
+      auto tail{_mm_loadu_si128((const __m128i *)(txt.data() + i + m - 1))};
+      unsigned mask = _mm_movemask_epi8(_mm_and_si128(
+          _mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last)));
+      for (; mask; mask &= mask - 1) {
+        std::size_t j = i + std::countr_zero(mask);
+        if (middle(txt, j)) visit(j);
+      }
+    }
+    return i;
+  }
+#endif
+};
+
+// Aho-Corasick automaton over all patterns, built once
+// bytes that occur in no pattern share class 0 and lead back to the root;
+// the goto function is a full DFA over byte classes when it fits in
+// denseLimit entries, otherwise each state keeps its sorted edges and
+// misses follow failure links
+struct AhoCorasick {
+  struct Match {
+    int pattern;
+    std::size_t pos;
+    bool operator==(const Match &) const = default;
+    auto operator<=>(const Match &) const = default;
+  };
+
+  // 257 classes when patterns use every byte, so 16 bits
+  std::array<std::uint16_t, 256> cls{};
+  int classes{1};
+  std::vector<std::size_t> length;
+  // per state: failure link, nearest state on the failure chain with
+  // output (0 if none), first pattern ending here (-1 if none)
+  std::vector<int> fail, dict, out;
+  // patterns equal to one another are chained
+  std::vector<int> same;
+  bool dense{false};
+  std::vector<int> delta;
+  // compressed: edges of state u are edges[first[u], first[u + 1])
+  std::vector<int> first;
+  std::vector<std::pair<std::uint16_t, int>> edges;
+
+  explicit AhoCorasick(std::span<const std::string_view> patterns,
+                       std::size_t denseLimit = 1 << 22) {
+    for (auto pat : patterns)
+      for (unsigned char b : pat)
+        if (!cls[b]) cls[b] = classes++;
+
+    // trie with sorted child lists
+    std::vector<std::vector<std::pair<std::uint16_t, int>>> trie(1);
+    out.push_back(-1);
+    for (int id = 0; id < (int)patterns.size(); id++) {
+      auto pat{patterns[id]};
+      assert(!pat.empty());
+      int u{0};
+      for (unsigned char b : pat) {
+        auto &kids{trie[u]};
+        auto it{std::ranges::lower_bound(
+            kids, cls[b], {}, &std::pair<std::uint16_t, int>::first)};
+        if (it == kids.end() || it->first != cls[b]) {
+          it = kids.insert(it, {cls[b], (int)trie.size()});
+          trie.emplace_back();
+          out.push_back(-1);
+        }
+        u = it->second;
+      }
+      length.push_back(pat.size());
+      same.push_back(out[u]);
+      out[u] = id;
+    }
+
+    int states = trie.size();
+    fail.assign(states, 0), dict.assign(states, 0);
+    first.assign(states + 1, 0);
+    for (int u = 0; u < states; u++) first[u + 1] = first[u] + trie[u].size();
+    for (const auto &kids : trie)
+      edges.insert(edges.end(), kids.begin(), kids.end());
+
+    // failure links in BFS order, a state's link is shallower than itself
+    std::vector<int> order{0};
+    for (std::size_t k = 0; k < order.size(); k++) {
+      int u{order[k]};
+      for (auto [c, v] : trie[u]) {
+        fail[v] = u == 0 ? 0 : step(fail[u], c);
+        dict[v] = out[fail[v]] != -1 ? fail[v] : dict[fail[v]];
+        order.push_back(v);
+      }
+    }
+
+    dense = (std::size_t)states * classes <= denseLimit;
+    if (dense) {
+      delta.assign(states * classes, 0);
+      for (int u : order) {
+        int *row{&delta[u * classes]};
+        if (u) std::copy_n(&delta[fail[u] * classes], classes, row);
+        for (auto [c, v] : trie[u]) row[c] = v;
+      }
+    }
+  }
+
+  int child(int u, std::uint16_t c) const {
+    auto lo{edges.begin() + first[u]}, hi{edges.begin() + first[u + 1]};
+    auto it{std::lower_bound(lo, hi, c, [](const auto &e, std::uint16_t c) {
+      return e.first < c;
+    })};
+    return it != hi && it->first == c ? it->second : -1;
+  }
+
+  int step(int u, std::uint16_t c) const {
+    if (dense) return delta[u * classes + c];
+    if (c == 0) return 0;
+    for (;; u = fail[u]) {
+      int v{child(u, c)};
+      if (v != -1) return v;
+      if (u == 0) return 0;
+    }
+  }
+
+  // visit(match) for every occurrence, in order of its end
+  template <class Visit>
+  void scan(std::string_view txt, Visit visit) const {
+    int u{0};
+    for (std::size_t i = 0; i < txt.size(); i++) {
+      u = step(u, cls[(unsigned char)txt[i]]);
+      for (int t = out[u] != -1 ? u : dict[u]; t; t = dict[t])
+        for (int id = out[t]; id != -1; id = same[id])
+          visit(Match{id, i + 1 - length[id]});
+    }
+  }
+
+  std::vector<Match> search(std::string_view txt) const {
+    std::vector<Match> found;
+    scan(txt, [&](const Match &m) { found.push_back(m); });
+    return found;
+  }
+};
+
 int main() {
   char txt[]{"BAAABAABBB"};
   char pat[]{"AAABAAB"};
@@ -141,4 +475,87 @@ int main() {
   std::print("\n{}\t\n", txt);
   for (int i = 0; i < d; ++i) std::print(" ");
   std::print("{}\t\n", pat);
-}
\ No newline at end of file
+
+  // both matchers against every alignment, on texts with high bytes
+  std::mt19937 mt(std::random_device{}());
+  auto randomString = [&](int n, int alphabet) {
+    std::string str(n, ' ');
+    for (auto &c : str) c = "ab\xffz"[mt() % alphabet];
+    return str;
+  };
+  auto occurrences = [](std::string_view pat, std::string_view txt) {
+    std::vector<std::size_t> found;
+    for (std::size_t i = 0; i + pat.size() <= txt.size(); i++)
+      if (txt.substr(i, pat.size()) == pat) found.push_back(i);
+    return found;
+  };
+  for (int round = 0; round < 200; round++) {
+    std::string text{randomString(mt() % 300, 2 + round % 3)};
+    int m = 1 + mt() % (round % 2 ? 80 : 6);
+    std::string pat{randomString(m, 2 + round % 3)};
+    assert(CompiledPattern(pat).search(text) == occurrences(pat, text));
+    assert(BM::search(pat, text) == naiveMethod(pat, text));
+  }
+
+  std::vector<std::string> storage;
+  for (int k = 0; k < 300; k++)
+    storage.push_back(randomString(1 + mt() % 8, 3));
+  std::vector<std::string_view> patterns(storage.begin(), storage.end());
+  std::string text{randomString(5000, 4)};
+  std::vector<AhoCorasick::Match> expected;
+  for (int id = 0; id < (int)patterns.size(); id++)
+    for (auto pos : occurrences(patterns[id], text))
+      expected.push_back({id, pos});
+  std::ranges::sort(expected);
+  for (std::size_t limit : {std::size_t{0}, std::size_t{1} << 22}) {
+    AhoCorasick ac(patterns, limit);
+    assert(ac.dense == (limit > 0));
+    auto found{ac.search(text)};
+    std::ranges::sort(found);
+    assert(found == expected);
+  }
+
+  // patterns over every byte value, the last class must not alias class 0
+  {
+    std::vector<std::string> storage;
+    for (int b = 0; b < 256; b++) storage.push_back(std::string(1, (char)b));
+    for (int k = 0; k < 100; k++) {
+      std::string pat(1 + mt() % 4, ' ');
+      for (auto &c : pat) c = (char)(mt() % 256);
+      storage.push_back(pat);
+    }
+    std::vector<std::string_view> patterns(storage.begin(), storage.end());
+    std::string text(4000, ' ');
+    for (auto &c : text) c = (char)(mt() % 256);
+    std::vector<AhoCorasick::Match> expected;
+    for (int id = 0; id < (int)patterns.size(); id++)
+      for (auto pos : occurrences(patterns[id], text))
+        expected.push_back({id, pos});
+    std::ranges::sort(expected);
+    for (std::size_t limit : {std::size_t{0}, std::size_t{1} << 22}) {
+      AhoCorasick ac(patterns, limit);
+      assert(ac.classes == 257);
+      auto found{ac.search(text)};
+      std::ranges::sort(found);
+      assert(found == expected);
+    }
+  }
+
+  // the same stream cut into chunks of random sizes
+  for (int round = 0; round < 200; round++) {
+    std::string text{randomString(mt() % 500, 2 + round % 3)};
+    std::string pat{randomString(1 + mt() % 10, 2 + round % 3)};
+    StreamKMP kmp(pat);
+    StreamBM bm(pat);
+    std::vector<long long> byKMP, byBM;
+    for (std::size_t at = 0, len; at < text.size(); at += len) {
+      len = std::min<std::size_t>(mt() % 16, text.size() - at);
+      std::string_view chunk{std::string_view(text).substr(at, len)};
+      kmp.feed(chunk, [&](long long i) { byKMP.push_back(i); });
+      bm.feed(chunk, [&](long long i) { byBM.push_back(i); });
+    }
+    auto expected{occurrences(pat, text)};
+    assert(std::ranges::equal(byKMP, expected));
+    assert(std::ranges::equal(byBM, expected));
+  }
+}
@@ -1,12 +1,17 @@
 #include <algorithm>
+#include <cassert>
 #include <print>
+#include <random>
+#include <string>
 #include <string_view>
 #include <vector>
 
+#include "SuffixArray.hh"
+
 // suffix array
 auto suffix(std::string_view str) {
   std::vector<std::string_view> A;
-  for (int i = 0; i < str.size(); i++) A.push_back(str.substr(i, str.size()));
+  for (std::size_t i = 0; i < str.size(); i++) A.push_back(str.substr(i));
   std::ranges::sort(A);
   return A;
 }
@@ -19,34 +24,36 @@ std::string_view lcp(std::string_view S, std::string_view T) {
   return S.substr(0, n);
 }
 
-// longest repeated substring
+// longest repeated substring, the deepest adjacent pair in the suffix array
+template <std::signed_integral Index = std::int32_t>
 std::string_view lrs(std::string_view str) {
-  std::string_view lrs;
-  auto A{suffix(str)};
-  for (int i = 1; i < A.size(); i++) {
-    int n = std::min(A[i].size(), A[i - 1].size());
-    int j{0};
-    for (; j < n; j++)
-      if (A[i].at(j) != A[i - 1].at(j)) break;
-    if (j > lrs.size()) lrs = A[i].substr(0, j);
-  }
-  return lrs;
+  auto sa{suffixArray<Index>(str)};
+  auto height{lcpArray(str, sa)};
+  if (height.empty()) return str;
+  auto k{std::ranges::max_element(height) - height.begin()};
+  return str.substr(sa[k], height[k]);
 }
 
-// longest common substring
+// longest common substring, suffix array of S + separator + T; the answer is
+// the deepest adjacent pair with one suffix from each string
+template <std::signed_integral Index = std::int32_t>
 std::string_view lcs(std::string_view S, std::string_view T) {
-  std::string_view lcs;
-  auto A{suffix(S)}, B{suffix(T)};
-  int i{0}, j{0};
-  while (i < S.size() && j < T.size()) {
-    auto x{lcp(A[i], B[j])};
-    if (x.size() > lcs.size()) lcs = x;
-    if (A[i] < B[j])
-      i++;
-    else
-      j++;
-  }
-  return lcs;
+  std::size_t m{S.size()}, n{S.size() + 1 + T.size()};
+  std::vector<short> joined(n);
+  for (std::size_t i = 0; i < m; i++) joined[i] = (unsigned char)S[i] + 1;
+  joined[m] = 0;
+  for (std::size_t i = 0; i < T.size(); i++)
+    joined[m + 1 + i] = (unsigned char)T[i] + 1;
+  std::span<const short> s{joined};
+  auto sa{sais<Index>(s, 256)};
+  auto height{kasai(s, sa)};
+  Index best{0}, at{0}, split = m;
+  for (std::size_t k = 1; k < n; k++)
+    if ((sa[k - 1] < split) != (sa[k] < split) && height[k] > best) {
+      best = height[k];
+      at = std::min(sa[k - 1], sa[k]);
+    }
+  return S.substr(at, best);
 }
 
 int main() {
@@ -60,4 +67,46 @@ int main() {
   std::print("{}\n", lcs(S, T));
 
   std::print("{}\n", lcs(U, V));
+
+  std::mt19937 mt(std::random_device{}());
+  auto randomString = [&](int n, int alphabet) {
+    std::uniform_int_distribution<int> c('a', 'a' + alphabet - 1);
+    std::string s(n, ' ');
+    for (auto &x : s) x = c(mt);
+    return s;
+  };
+  auto naiveLcs = [](std::string_view S, std::string_view T) {
+    std::size_t best{0};
+    for (std::size_t i = 0; i < S.size(); i++)
+      for (std::size_t j = 0; j < T.size(); j++)
+        best = std::max(best, lcp(S.substr(i), T.substr(j)).size());
+    return best;
+  };
+  for (int trial = 0; trial < 500; trial++) {
+    int n{(int)(mt() % 300)}, alphabet{1 + (int)(mt() % 4)};
+    auto str{randomString(n, alphabet)};
+    auto expected{suffix(str)};
+    auto sa{suffixArray(str)};
+    auto sa64{suffixArray<std::int64_t>(str)};
+    auto height{lcpArray(str, sa)};
+    for (int k = 0; k < n; k++) {
+      assert(str.substr(sa[k]) == expected[k]);
+      assert(sa64[k] == sa[k]);
+      assert((std::size_t)height[k] ==
+             (k ? lcp(expected[k - 1], expected[k]).size() : 0));
+    }
+    auto repeat{lrs(str)};
+    assert(lrs<std::int64_t>(str) == repeat);
+    std::size_t longest{0};
+    for (int k = 1; k < n; k++)
+      longest = std::max(longest, lcp(expected[k - 1], expected[k]).size());
+    assert(repeat.size() == longest);
+    assert(str.find(repeat) != str.rfind(repeat) || repeat.empty());
+
+    auto other{randomString(mt() % 100, alphabet)};
+    auto common{lcs(str, other)};
+    assert(lcs<std::int64_t>(str, other) == common);
+    assert(common.size() == naiveLcs(str, other));
+    assert(other.find(common) != std::string_view::npos);
+  }
 }
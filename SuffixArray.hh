@@ -0,0 +1,140 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// SA-IS (Nong, Zhang & Chan), linear time suffix sorting
+// a suffix is S-type if it is smaller than the next one, L-type otherwise;
+// an S-type right after an L-type is LMS. One induced pass sorts the LMS
+// substrings, they are named by rank and, if two names tie, sorted for
+// good by recursing on the names; a second induced pass from the sorted
+// LMS suffixes then places every suffix
+// s[i] in [0, upper], Index is std::int32_t or std::int64_t
+template <std::signed_integral Index, class Symbol>
+std::vector<Index> sais(std::span<const Symbol> s, Index upper) {
+  // past Index the length would wrap, pick std::int64_t for such inputs
+  assert(s.size() <= (std::size_t)std::numeric_limits<Index>::max());
+  Index n = s.size();
+  if (n < 8) {
+    std::vector<Index> sa(n);
+    std::iota(sa.begin(), sa.end(), 0);
+    std::ranges::sort(sa, [&](Index a, Index b) {
+      return std::ranges::lexicographical_compare(s.subspan(a), s.subspan(b));
+    });
+    return sa;
+  }
+
+  std::vector<bool> stype(n);
+  for (Index i = n - 2; i >= 0; i--)
+    stype[i] = s[i] == s[i + 1] ? stype[i + 1] : s[i] < s[i + 1];
+  // bucket c holds its L-types from start[c], its S-types from startS[c]
+  std::vector<Index> start(upper + 1), startS(upper + 1);
+  for (Index i = 0; i < n; i++)
+    if (stype[i]) {
+      if (s[i] < upper) start[s[i] + 1]++;
+    } else
+      startS[s[i]]++;
+  for (Index c = 0; c <= upper; c++) {
+    startS[c] += start[c];
+    if (c < upper) start[c + 1] += startS[c];
+  }
+
+  std::vector<Index> sa(n), next(upper + 1);
+  auto induce = [&](const std::vector<Index> &lms) {
+    std::ranges::fill(sa, -1);
+    std::ranges::copy(startS, next.begin());
+    for (Index i : lms) sa[next[s[i]]++] = i;
+    // L-types left to right, the last suffix is L-type
+    std::ranges::copy(start, next.begin());
+    sa[next[s[n - 1]]++] = n - 1;
+    for (Index i = 0; i < n; i++)
+      if (Index v{sa[i]}; v >= 1 && !stype[v - 1])
+        sa[next[s[v - 1]]++] = v - 1;
+    // S-types right to left, filling each bucket from its end; an S-type
+    // symbol is never upper, so start[c + 1] is in range
+    std::ranges::copy(start, next.begin());
+    for (Index i = n - 1; i >= 0; i--)
+      if (Index v{sa[i]}; v >= 1 && stype[v - 1])
+        sa[--next[s[v - 1] + 1]] = v - 1;
+  };
+
+  std::vector<Index> lms, name(n, -1);
+  for (Index i = 1; i < n; i++)
+    if (stype[i] && !stype[i - 1]) {
+      name[i] = lms.size();
+      lms.push_back(i);
+    }
+  Index m = lms.size();
+  induce(lms);
+  if (m == 0) return sa;
+
+  std::vector<Index> sorted;
+  sorted.reserve(m);
+  for (Index v : sa)
+    if (name[v] != -1) sorted.push_back(v);
+  // equal LMS substrings share a name
+  std::vector<Index> reduced(m);
+  Index names{0};
+  reduced[name[sorted[0]]] = 0;
+  for (Index k = 1; k < m; k++) {
+    Index l{sorted[k - 1]}, r{sorted[k]};
+    Index endL{name[l] + 1 < m ? lms[name[l] + 1] : n};
+    Index endR{name[r] + 1 < m ? lms[name[r] + 1] : n};
+    bool same{endL - l == endR - r};
+    if (same) {
+      while (l < endL && s[l] == s[r]) l++, r++;
+      same = l < n && s[l] == s[r];
+    }
+    if (!same) names++;
+    reduced[name[sorted[k]]] = names;
+  }
+  auto order{sais<Index>(std::span<const Index>(reduced), names)};
+  for (Index k = 0; k < m; k++) sorted[k] = lms[order[k]];
+  induce(sorted);
+  return sa;
+}
+
+template <std::signed_integral Index = std::int32_t>
+std::vector<Index> suffixArray(std::string_view text) {
+  std::span<const unsigned char> s{(const unsigned char *)text.data(),
+                                   text.size()};
+  return sais<Index>(s, 255);
+}
+
+// Kasai, lcp[k] is the common prefix length of the suffixes sa[k - 1] and
+// sa[k], lcp[0] = 0; the prefix shrinks by at most one from suffix i to
+// suffix i + 1, so the scans are linear in total
+template <std::signed_integral Index, class Symbol>
+std::vector<Index> kasai(std::span<const Symbol> s,
+                         const std::vector<Index> &sa) {
+  assert(s.size() == sa.size());
+  assert(s.size() <= (std::size_t)std::numeric_limits<Index>::max());
+  Index n = s.size();
+  std::vector<Index> rank(n), lcp(n);
+  for (Index k = 0; k < n; k++) rank[sa[k]] = k;
+  for (Index i = 0, h = 0; i < n; i++) {
+    if (h > 0) h--;
+    if (rank[i] == 0) {
+      h = 0;
+      continue;
+    }
+    Index j{sa[rank[i] - 1]};
+    while (i + h < n && j + h < n && s[i + h] == s[j + h]) h++;
+    lcp[rank[i]] = h;
+  }
+  return lcp;
+}
+
+template <std::signed_integral Index>
+std::vector<Index> lcpArray(std::string_view text,
+                            const std::vector<Index> &sa) {
+  std::span<const unsigned char> s{(const unsigned char *)text.data(),
+                                   text.size()};
+  return kasai(s, sa);
+}
@@ -0,0 +1,143 @@
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <limits>
+#include <print>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SuffixArrayFile.hh"
+
+template <class F>
+double millis(F &&f) {
+  auto start{std::chrono::steady_clock::now()};
+  f();
+  std::chrono::duration<double, std::milli> elapsed{
+      std::chrono::steady_clock::now() - start};
+  return elapsed.count();
+}
+
+int main(int argc, char *argv[]) {
+  int n{argc > 1 ? std::atoi(argv[1]) : 1 << 20};
+  std::mt19937 mt(std::random_device{}());
+  auto randomString = [&](int n, int alphabet) {
+    std::uniform_int_distribution<int> c('a', 'a' + alphabet - 1);
+    std::string s(n, ' ');
+    for (auto &x : s) x = c(mt);
+    return s;
+  };
+  auto occurrences = [](std::string_view pat, std::string_view txt) {
+    std::vector<int> at;
+    for (auto i{txt.find(pat)}; i != txt.npos; i = txt.find(pat, i + 1))
+      at.push_back(i);
+    return at;
+  };
+  auto dir{std::filesystem::temp_directory_path()};
+  std::string path{dir / ("SuffixArrayFile." + std::to_string(mt()))};
+
+  for (int trial = 0; trial < 50; trial++) {
+    auto txt{randomString(mt() % 2000, 1 + trial % 4)};
+    [[maybe_unused]] bool written{writeSuffixIndex(path, txt)};
+    assert(written);
+    auto index{MappedSuffixIndex<>::open(path)};
+    assert(index && index->text() == txt);
+    auto sa{suffixArray(txt)};
+    auto lcp{lcpArray(txt, sa)};
+    assert(std::ranges::equal(index->sa(), sa));
+    assert(std::ranges::equal(index->lcp(), lcp));
+    for (int q = 0; q < 20; q++) {
+      auto pat{randomString(1 + mt() % 6, 1 + trial % 4)};
+      auto expected{occurrences(pat, txt)};
+      std::vector<int> found(index->locate(pat).begin(),
+                             index->locate(pat).end());
+      std::ranges::sort(found);
+      assert(index->count(pat) == expected.size() && found == expected);
+    }
+    assert(index->lrs().size() ==
+           (txt.empty() ? 0u : (std::size_t)std::ranges::max(lcp)));
+  }
+
+  // a reader of the wrong width, a truncated file and a future version
+  // asserts are compiled out under NDEBUG, so no writes inside them
+  [[maybe_unused]] bool written{
+      writeSuffixIndex(path, "itwasthebestoftimesitwastheworstoftimes")};
+  assert(written);
+  assert(MappedSuffixIndex<>::open(path)->lrs() == "stoftimes");
+  assert(!MappedSuffixIndex<std::int64_t>::open(path));
+  auto size{std::filesystem::file_size(path)};
+  std::filesystem::resize_file(path, size - 1);
+  assert(!MappedSuffixIndex<>::open(path));
+  written = writeSuffixIndex<std::int64_t>(path, "banana");
+  assert(written);
+  assert(MappedSuffixIndex<std::int64_t>::open(path)->count("ana") == 2);
+  {
+    std::FILE *f{std::fopen(path.c_str(), "r+b")};
+    std::uint32_t version{SuffixIndexHeader::VERSION + 1};
+    std::fseek(f, offsetof(SuffixIndexHeader, version), SEEK_SET);
+    std::fwrite(&version, sizeof(version), 1, f);
+    std::fclose(f);
+  }
+  assert(!MappedSuffixIndex<std::int64_t>::open(path));
+  assert(!MappedSuffixIndex<>::open(path + ".missing"));
+
+  // a text longer than Index can count is refused, the index in place stays
+  written = writeSuffixIndex<std::int16_t>(path, "banana");
+  assert(written);
+  assert(MappedSuffixIndex<std::int16_t>::open(path)->count("an") == 2);
+  written = writeSuffixIndex<std::int16_t>(path, randomString(40000, 4));
+  assert(!written);
+  assert(MappedSuffixIndex<std::int16_t>::open(path)->text() == "banana");
+
+  // a length whose section sizes wrap 64 bits, with the wrapped layout
+  written = writeSuffixIndex<std::int64_t>(path, "banana");
+  assert(written);
+  {
+    auto forged{SuffixIndexHeader::layout<std::int64_t>(
+        std::numeric_limits<std::uint64_t>::max() / 17 + 1)};
+    std::FILE *f{std::fopen(path.c_str(), "r+b")};
+    std::fwrite(&forged, sizeof(forged), 1, f);
+    std::fclose(f);
+  }
+  assert(!MappedSuffixIndex<std::int64_t>::open(path));
+
+  // writers racing on one index leave one whole index and no temp files
+  {
+    std::string texts[]{randomString(5000, 2), randomString(7000, 3)};
+    {
+      std::vector<std::jthread> writers;
+      for (const auto &txt : texts)
+        writers.emplace_back([&] {
+          for (int round = 0; round < 10; round++) {
+            [[maybe_unused]] bool ok{writeSuffixIndex(path, txt)};
+            assert(ok);
+          }
+        });
+    }
+    auto index{MappedSuffixIndex<>::open(path)};
+    assert(index && (index->text() == texts[0] || index->text() == texts[1]));
+    assert(std::ranges::equal(index->sa(), suffixArray(index->text())));
+    std::string stem{std::filesystem::path(path).filename()};
+    for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+      std::string name{entry.path().filename()};
+      assert(name == stem || !name.starts_with(stem));
+    }
+  }
+
+  // worker startup, rebuilding against mapping the prebuilt index
+  auto txt{randomString(n, 4)};
+  double build{millis([&] { lcpArray(txt, suffixArray(txt)); })};
+  written = writeSuffixIndex(path, txt);
+  assert(written);
+  std::size_t hits{0};
+  double mapped{millis([&] {
+    auto index{MappedSuffixIndex<>::open(path)};
+    hits = index->count(txt.substr(n / 2, 8));
+  })};
+  assert(written && hits > 0);
+  std::print("n {}\trebuild {:.1f} ms\tmmap and query {:.3f} ms\n", n, build,
+             mapped);
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,201 @@
+#pragma once
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "SuffixArray.hh"
+
+// on-disk suffix array index, a 64 byte header followed by the text, the
+// suffix array and the LCP array, each section 64 byte aligned so the
+// mapped arrays can be used in place; readers map it shared and read only,
+// so every process on the host queries the same page cache copy
+struct SuffixIndexHeader {
+  static constexpr std::uint64_t MAGIC{0x5844584946465553}; // "SUFFIXDX"
+  static constexpr std::uint32_t VERSION{1};
+  // written natively, reads back swapped on a host of the other byte order
+  static constexpr std::uint32_t ORDER{0x01020304};
+
+  std::uint64_t magic{MAGIC};
+  std::uint32_t version{VERSION};
+  std::uint32_t order{ORDER};
+  std::uint32_t indexBytes{0};
+  std::uint32_t reserved{0};
+  std::uint64_t length{0};
+  std::uint64_t textOffset{0}, saOffset{0}, lcpOffset{0}, fileBytes{0};
+
+  static std::uint64_t align(std::uint64_t x) { return (x + 63) & ~63ull; }
+
+  template <class Index>
+  static SuffixIndexHeader layout(std::uint64_t n) {
+    SuffixIndexHeader h;
+    h.indexBytes = sizeof(Index);
+    h.length = n;
+    h.textOffset = align(sizeof(SuffixIndexHeader));
+    h.saOffset = align(h.textOffset + n);
+    h.lcpOffset = align(h.saOffset + n * sizeof(Index));
+    h.fileBytes = h.lcpOffset + n * sizeof(Index);
+    return h;
+  }
+};
+static_assert(sizeof(SuffixIndexHeader) == 64);
+
+// builds the index of text and writes it to path; the file is written to
+// a unique name beside path, synced and renamed over it, so readers never
+// map a partial index, even after a crash, and concurrent writers of the
+// same index do not clobber each other; false, with nothing written, when
+// the text is too long for Index, as open would reject the file
+template <std::signed_integral Index = std::int32_t>
+bool writeSuffixIndex(const std::string &path, std::string_view text) {
+  if (text.size() > (std::size_t)std::numeric_limits<Index>::max())
+    return false;
+  auto sa{suffixArray<Index>(text)};
+  auto lcp{lcpArray(text, sa)};
+  auto h{SuffixIndexHeader::layout<Index>(text.size())};
+
+  std::string tmp{path + ".XXXXXX"};
+  int fd{mkstemp(tmp.data())};
+  if (fd < 0) return false;
+  // mkstemp creates the file private to its owner
+  fchmod(fd, 0644);
+  std::FILE *f{fdopen(fd, "wb")};
+  if (!f) {
+    ::close(fd);
+    std::remove(tmp.c_str());
+    return false;
+  }
+  auto put = [&](std::uint64_t offset, const void *p, std::size_t bytes) {
+    return std::fseek(f, offset, SEEK_SET) == 0 &&
+           std::fwrite(p, 1, bytes, f) == bytes;
+  };
+  bool ok{put(0, &h, sizeof(h)) && put(h.textOffset, text.data(), h.length) &&
+          put(h.saOffset, sa.data(), sa.size() * sizeof(Index)) &&
+          put(h.lcpOffset, lcp.data(), lcp.size() * sizeof(Index))};
+  // the last section may be empty, pad the file out to its stated size
+  ok = ok && std::fflush(f) == 0 && ftruncate(fd, h.fileBytes) == 0;
+  // the data must be on disk before the name points at it
+  ok = ok && fsync(fd) == 0;
+  ok = std::fclose(f) == 0 && ok;
+  if (ok) ok = std::rename(tmp.c_str(), path.c_str()) == 0;
+  if (!ok) std::remove(tmp.c_str());
+  return ok;
+}
+
+// read-only view of an index file, open returns nullopt when the file is
+// missing, truncated, of another version or byte order, or was written
+// with another Index width
+template <std::signed_integral Index = std::int32_t>
+class MappedSuffixIndex {
+  void *base{nullptr};
+  std::size_t bytes{0};
+  SuffixIndexHeader h;
+
+  MappedSuffixIndex(void *base, std::size_t bytes, SuffixIndexHeader h)
+      : base{base}, bytes{bytes}, h{h} {}
+
+  const char *at(std::uint64_t offset) const {
+    return static_cast<const char *>(base) + offset;
+  }
+
+ public:
+  static std::optional<MappedSuffixIndex> open(const std::string &path) {
+    int fd{::open(path.c_str(), O_RDONLY)};
+    if (fd < 0) return std::nullopt;
+    SuffixIndexHeader h;
+    struct stat st;
+    void *p{MAP_FAILED};
+    std::size_t size{0};
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(h)) {
+      size = st.st_size;
+      p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    // the mapping outlives the descriptor
+    ::close(fd);
+    if (p == MAP_FAILED) return std::nullopt;
+
+    std::memcpy(&h, p, sizeof(h));
+    // a corrupt length must not wrap the offsets computed from it
+    if (h.length > (size - sizeof(h)) / (1 + 2 * sizeof(Index))) {
+      munmap(p, size);
+      return std::nullopt;
+    }
+    auto expected{SuffixIndexHeader::layout<Index>(h.length)};
+    bool valid{h.magic == h.MAGIC && h.version == h.VERSION &&
+               h.order == h.ORDER && h.indexBytes == sizeof(Index) &&
+               h.length <= (std::uint64_t)std::numeric_limits<Index>::max() &&
+               h.textOffset == expected.textOffset &&
+               h.saOffset == expected.saOffset &&
+               h.lcpOffset == expected.lcpOffset &&
+               h.fileBytes == expected.fileBytes && h.fileBytes <= size};
+    if (!valid) {
+      munmap(p, size);
+      return std::nullopt;
+    }
+    // binary search touches the suffix array at random
+    madvise(p, size, MADV_RANDOM);
+    return MappedSuffixIndex(p, size, h);
+  }
+
+  MappedSuffixIndex(MappedSuffixIndex &&other) noexcept
+      : base{std::exchange(other.base, nullptr)}, bytes{other.bytes},
+        h{other.h} {}
+  MappedSuffixIndex &operator=(MappedSuffixIndex &&other) noexcept {
+    std::swap(base, other.base);
+    std::swap(bytes, other.bytes);
+    std::swap(h, other.h);
+    return *this;
+  }
+  ~MappedSuffixIndex() {
+    if (base) munmap(base, bytes);
+  }
+
+  std::string_view text() const { return {at(h.textOffset), h.length}; }
+  std::span<const Index> sa() const {
+    return {reinterpret_cast<const Index *>(at(h.saOffset)), h.length};
+  }
+  std::span<const Index> lcp() const {
+    return {reinterpret_cast<const Index *>(at(h.lcpOffset)), h.length};
+  }
+
+  // suffix array rows [lo, hi) of the suffixes prefixed by pattern
+  std::pair<std::size_t, std::size_t> range(std::string_view pattern) const {
+    auto str{text()};
+    auto A{sa()};
+    auto prefix = [&](Index i) { return str.substr(i, pattern.size()); };
+    auto lo{std::ranges::lower_bound(A, pattern, {}, prefix)};
+    auto hi{std::ranges::upper_bound(lo, A.end(), pattern, {}, prefix)};
+    return {lo - A.begin(), hi - A.begin()};
+  }
+
+  std::size_t count(std::string_view pattern) const {
+    auto [lo, hi]{range(pattern)};
+    return hi - lo;
+  }
+
+  // every position of pattern, in suffix order
+  std::span<const Index> locate(std::string_view pattern) const {
+    auto [lo, hi]{range(pattern)};
+    return sa().subspan(lo, hi - lo);
+  }
+
+  // longest repeated substring, as lrs in SuffixArray.cc
+  std::string_view lrs() const {
+    if (h.length == 0) return text();
+    auto height{lcp()};
+    auto k{std::ranges::max_element(height) - height.begin()};
+    return text().substr(sa()[k], height[k]);
+  }
+};
@@ -1,8 +1,18 @@
+#include <algorithm>
+#include <bit>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <print>
+#include <random>
+#include <set>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 struct Trie {
   struct Node {
@@ -98,6 +108,410 @@ struct Trie {
   }
 };
 
+// adaptive radix tree (Leis, Kemper & Neumann) over 8-bit keys
+// a node stores the bytes its whole subtree shares as a compressed path and
+// grows from a leaf to 4, 16, 48 and 256 children, shrinking back as
+// children go; every node except the root ends a key or branches, so
+// operations take one step per branch and a key set costs a few dozen
+// bytes per key instead of a 128-pointer node per byte
+struct AdaptiveRadixTree {
+  enum class Kind : std::uint8_t { Leaf, N4, N16, N48, N256 };
+  struct Node {
+    Kind kind;
+    bool val{false};
+    std::uint16_t count{0};
+    std::string prefix;
+    explicit Node(Kind kind) : kind{kind} {}
+  };
+  // children sorted by key byte
+  template <int N, Kind K>
+  struct NodeN : Node {
+    std::uint8_t key[N]{};
+    Node *child[N]{};
+    NodeN() : Node{K} {}
+  };
+  struct Leaf : Node {
+    Leaf() : Node{Kind::Leaf} {}
+  };
+  using Node4 = NodeN<4, Kind::N4>;
+  using Node16 = NodeN<16, Kind::N16>;
+  // slot[c] is one past the index of child c, 0 if absent
+  struct Node48 : Node {
+    std::uint8_t slot[256]{};
+    Node *child[48]{};
+    Node48() : Node{Kind::N48} {}
+  };
+  struct Node256 : Node {
+    Node *child[256]{};
+    Node256() : Node{Kind::N256} {}
+  };
+
+  Node *root{nullptr};
+  int sz{0};
+  AdaptiveRadixTree() {}
+  AdaptiveRadixTree(const AdaptiveRadixTree &) = delete;
+  AdaptiveRadixTree &operator=(const AdaptiveRadixTree &) = delete;
+  int size() { return sz; }
+  bool empty() { return size() == 0; }
+
+  static int capacity(Kind kind) {
+    constexpr int cap[]{0, 4, 16, 48, 256};
+    return cap[(int)kind];
+  }
+  // a node at or below this count moves down one kind
+  static int shrinkAt(Kind kind) {
+    constexpr int at[]{-1, 0, 3, 12, 40};
+    return at[(int)kind];
+  }
+
+  // frees x alone, not its children
+  static void destroy(Node *x) {
+    switch (x->kind) {
+      case Kind::Leaf: delete static_cast<Leaf *>(x); break;
+      case Kind::N4: delete static_cast<Node4 *>(x); break;
+      case Kind::N16: delete static_cast<Node16 *>(x); break;
+      case Kind::N48: delete static_cast<Node48 *>(x); break;
+      default: delete static_cast<Node256 *>(x);
+    }
+  }
+  static std::size_t footprint(Node *x) {
+    constexpr std::size_t size[]{sizeof(Leaf), sizeof(Node4), sizeof(Node16),
+                                 sizeof(Node48), sizeof(Node256)};
+    // prefixes past the small string buffer live on the heap
+    auto heap{x->prefix.capacity() > 15 ? x->prefix.capacity() + 1 : 0};
+    return size[(int)x->kind] + heap;
+  }
+
+  template <int N, Kind K>
+  static Node **findSorted(NodeN<N, K> *x, std::uint8_t c) {
+#if defined(__SSE2__)
+    if constexpr (N == 16) {
+      auto keys{_mm_loadu_si128((const __m128i *)x->key)};
+      auto eq{_mm_cmpeq_epi8(_mm_set1_epi8(c), keys)};
+      int mask{_mm_movemask_epi8(eq) & ((1 << x->count) - 1)};
+      return mask ? &x->child[std::countr_zero((unsigned)mask)] : nullptr;
+    }
+#endif
+    for (int i = 0; i < x->count && x->key[i] <= c; i++)
+      if (x->key[i] == c) return &x->child[i];
+    return nullptr;
+  }
+
+  static Node **findChild(Node *x, std::uint8_t c) {
+    switch (x->kind) {
+      case Kind::N4: return findSorted(static_cast<Node4 *>(x), c);
+      case Kind::N16: return findSorted(static_cast<Node16 *>(x), c);
+      case Kind::N48: {
+        auto n{static_cast<Node48 *>(x)};
+        return n->slot[c] ? &n->child[n->slot[c] - 1] : nullptr;
+      }
+      case Kind::N256: {
+        auto n{static_cast<Node256 *>(x)};
+        return n->child[c] ? &n->child[c] : nullptr;
+      }
+      default: return nullptr;
+    }
+  }
+
+  // visits the children of x in byte order
+  template <class F>
+  static void forEach(Node *x, F &&visit) {
+    auto sorted = [&](auto *n) {
+      for (int i = 0; i < n->count; i++) visit(n->key[i], n->child[i]);
+    };
+    switch (x->kind) {
+      case Kind::N4: sorted(static_cast<Node4 *>(x)); break;
+      case Kind::N16: sorted(static_cast<Node16 *>(x)); break;
+      case Kind::N48: {
+        auto n{static_cast<Node48 *>(x)};
+        for (int c = 0; c < 256; c++)
+          if (n->slot[c]) visit(c, n->child[n->slot[c] - 1]);
+        break;
+      }
+      case Kind::N256: {
+        auto n{static_cast<Node256 *>(x)};
+        for (int c = 0; c < 256; c++)
+          if (n->child[c]) visit(c, n->child[c]);
+        break;
+      }
+      default: break;
+    }
+  }
+
+  // x has room for one more child
+  template <int N, Kind K>
+  static void add(NodeN<N, K> *x, std::uint8_t c, Node *child) {
+    int i{x->count++};
+    for (; i > 0 && x->key[i - 1] > c; i--) {
+      x->key[i] = x->key[i - 1];
+      x->child[i] = x->child[i - 1];
+    }
+    x->key[i] = c;
+    x->child[i] = child;
+  }
+  // children are kept packed, so the next free index is count
+  static void add(Node48 *x, std::uint8_t c, Node *child) {
+    x->child[x->count] = child;
+    x->slot[c] = ++x->count;
+  }
+  static void add(Node256 *x, std::uint8_t c, Node *child) {
+    x->child[c] = child;
+    x->count++;
+  }
+  static void addChild(Node *x, std::uint8_t c, Node *child) {
+    switch (x->kind) {
+      case Kind::N4: return add(static_cast<Node4 *>(x), c, child);
+      case Kind::N16: return add(static_cast<Node16 *>(x), c, child);
+      case Kind::N48: return add(static_cast<Node48 *>(x), c, child);
+      default: return add(static_cast<Node256 *>(x), c, child);
+    }
+  }
+
+  static void eraseChild(Node *x, std::uint8_t c) {
+    auto sorted = [&](auto *n) {
+      int i{0};
+      while (n->key[i] != c) i++;
+      for (; i + 1 < n->count; i++) {
+        n->key[i] = n->key[i + 1];
+        n->child[i] = n->child[i + 1];
+      }
+    };
+    switch (x->kind) {
+      case Kind::N4: sorted(static_cast<Node4 *>(x)); break;
+      case Kind::N16: sorted(static_cast<Node16 *>(x)); break;
+      case Kind::N48: {
+        // the last child fills the hole
+        auto n{static_cast<Node48 *>(x)};
+        int i{n->slot[c] - 1}, last{n->count - 1};
+        n->slot[c] = 0;
+        if (i != last) {
+          n->child[i] = n->child[last];
+          int d{0};
+          while (n->slot[d] != last + 1) d++;
+          n->slot[d] = i + 1;
+        }
+        n->child[last] = nullptr;
+        break;
+      }
+      default: static_cast<Node256 *>(x)->child[c] = nullptr;
+    }
+    x->count--;
+  }
+
+  // moves the key, path and children of ref into a node of another kind
+  static Node *resize(Node *&ref, Kind kind) {
+    auto into = [&](auto *n) -> Node * {
+      Node *x{ref};
+      n->val = x->val;
+      n->prefix = std::move(x->prefix);
+      if constexpr (!std::is_same_v<decltype(n), Leaf *>)
+        forEach(x, [&](std::uint8_t c, Node *child) { add(n, c, child); });
+      destroy(x);
+      return ref = n;
+    };
+    switch (kind) {
+      case Kind::Leaf: return into(new Leaf);
+      case Kind::N4: return into(new Node4);
+      case Kind::N16: return into(new Node16);
+      case Kind::N48: return into(new Node48);
+      default: return into(new Node256);
+    }
+  }
+
+  // ref ends no key and has one child, append the child's path to it
+  static void merge(Node *&ref) {
+    Node *x{ref};
+    forEach(x, [&](std::uint8_t c, Node *child) {
+      child->prefix.insert(0, 1, (char)c);
+      child->prefix.insert(0, x->prefix);
+      ref = child;
+    });
+    destroy(x);
+  }
+
+  static Node *leaf(std::string_view rest) {
+    Node *x{new Leaf};
+    x->val = true;
+    x->prefix = rest;
+    return x;
+  }
+
+  // the node at which key ends, if any
+  Node *find(std::string_view key) {
+    Node *x{root};
+    for (std::size_t d = 0; x; d++) {
+      if (!key.substr(d).starts_with(x->prefix)) return nullptr;
+      d += x->prefix.size();
+      if (d == key.size()) return x;
+      Node **next{findChild(x, key[d])};
+      x = next ? *next : nullptr;
+    }
+    return nullptr;
+  }
+
+  bool contains(std::string_view key) {
+    Node *x{find(key)};
+    return x ? x->val : false;
+  }
+
+  void insert(std::string_view key) {
+    Node **ref{&root};
+    for (std::size_t d = 0;; d++) {
+      Node *x{*ref};
+      if (x == nullptr) {
+        *ref = leaf(key.substr(d));
+        sz++;
+        return;
+      }
+      auto rest{key.substr(d)};
+      std::size_t p = std::ranges::mismatch(x->prefix, rest).in1 -
+                      x->prefix.begin();
+      if (p < x->prefix.size()) {
+        // the key leaves the path of x at p, split it there
+        auto n{new Node4};
+        n->prefix = x->prefix.substr(0, p);
+        add(n, x->prefix[p], x);
+        x->prefix.erase(0, p + 1);
+        if (p == rest.size())
+          n->val = true;
+        else
+          add(n, rest[p], leaf(rest.substr(p + 1)));
+        *ref = n;
+        sz++;
+        return;
+      }
+      d += p;
+      if (d == key.size()) {
+        if (x->val == false) sz++;
+        x->val = true;
+        return;
+      }
+      if (Node **next{findChild(x, key[d])}) {
+        ref = next;
+        continue;
+      }
+      if (x->count == capacity(x->kind))
+        x = resize(*ref, Kind((int)x->kind + 1));
+      addChild(x, key[d], leaf(key.substr(d + 1)));
+      sz++;
+      return;
+    }
+  }
+
+  void remove(std::string_view key) {
+    Node **ref{&root}, **up{nullptr};
+    std::uint8_t via{0};
+    for (std::size_t d = 0;; d++) {
+      Node *x{*ref};
+      if (x == nullptr || !key.substr(d).starts_with(x->prefix)) return;
+      d += x->prefix.size();
+      if (d == key.size()) break;
+      Node **next{findChild(x, key[d])};
+      if (next == nullptr) return;
+      up = ref;
+      ref = next;
+      via = key[d];
+    }
+    Node *x{*ref};
+    if (x->val == false) return;
+    x->val = false;
+    sz--;
+    if (x->count == 1) return merge(*ref);
+    if (x->count != 0) return;
+
+    destroy(x);
+    if (up == nullptr) {
+      root = nullptr;
+      return;
+    }
+    Node *parent{*up};
+    eraseChild(parent, via);
+    if (parent->count <= shrinkAt(parent->kind))
+      parent = resize(*up, Kind((int)parent->kind - 1));
+    // a parent ending no key had two children at least
+    if (parent->val == false && parent->count == 1) merge(*up);
+  }
+
+  std::vector<std::string> keysWithPrefix(std::string_view prefix) {
+    std::vector<std::string> results;
+    Node *x{root};
+    std::size_t d{0};
+    while (x) {
+      auto rest{prefix.substr(d)};
+      if (std::string_view(x->prefix).starts_with(rest)) break;
+      if (!rest.starts_with(x->prefix)) return results;
+      d += x->prefix.size();
+      Node **next{findChild(x, prefix[d])};
+      x = next ? *next : nullptr;
+      d++;
+    }
+    if (x == nullptr) return results;
+
+    // explicit stack of (node, key length above it, byte leading to it)
+    struct Frame {
+      Node *x;
+      std::size_t depth;
+      int via;
+    };
+    std::vector<Frame> stack{{x, d, -1}};
+    std::string key{prefix.substr(0, d)};
+    while (!stack.empty()) {
+      auto [x, depth, via]{stack.back()};
+      stack.pop_back();
+      key.resize(depth);
+      if (via >= 0) key.push_back(via);
+      key += x->prefix;
+      if (x->val) results.push_back(key);
+      auto top{stack.size()};
+      forEach(x, [&](std::uint8_t c, Node *child) {
+        stack.push_back({child, key.size(), c});
+      });
+      std::reverse(stack.begin() + top, stack.end());
+    }
+    return results;
+  }
+
+  std::string_view longestPrefixOf(std::string_view query) {
+    int length{-1};
+    Node *x{root};
+    for (std::size_t d = 0; x; d++) {
+      if (!query.substr(d).starts_with(x->prefix)) break;
+      d += x->prefix.size();
+      if (x->val) length = d;
+      if (d == query.size()) break;
+      Node **next{findChild(x, query[d])};
+      x = next ? *next : nullptr;
+    }
+    if (length == -1) return "";
+    return query.substr(0, length);
+  }
+
+  // heap bytes held by the nodes
+  std::size_t bytes() {
+    std::size_t total{0};
+    std::vector<Node *> stack;
+    if (root) stack.push_back(root);
+    while (!stack.empty()) {
+      Node *x{stack.back()};
+      stack.pop_back();
+      total += footprint(x);
+      forEach(x, [&](std::uint8_t, Node *child) { stack.push_back(child); });
+    }
+    return total;
+  }
+
+  ~AdaptiveRadixTree() {
+    std::vector<Node *> stack;
+    if (root) stack.push_back(root);
+    while (!stack.empty()) {
+      Node *x{stack.back()};
+      stack.pop_back();
+      forEach(x, [&](std::uint8_t, Node *child) { stack.push_back(child); });
+      destroy(x);
+    }
+  }
+};
+
 int main() {
   Trie retrieval;
   retrieval.insert("size");
@@ -132,4 +546,80 @@ int main() {
   assert(retrieval.size() == 9);
   for (const auto &e : retrieval.keysWithPrefix("")) std::print("{}\n", e);
   std::print("{}\n", retrieval.longestPrefixOf("retrieval"));
+
+  AdaptiveRadixTree art;
+  for (auto key : {"r", "re", "ret", "retr", "retri", "retrie", "retriev",
+                   "retrieva", "retrieval"})
+    art.insert(key);
+  assert(art.size() == 9);
+  assert(art.keysWithPrefix("") == retrieval.keysWithPrefix(""));
+  assert(art.longestPrefixOf("retrievable") == "retrieva");
+
+  // random operations over 8-bit keys against std::set, whose order is
+  // unsigned bytewise too; small alphabets nest keys, 256 fills Node256
+  std::mt19937 mt(std::random_device{}());
+  for (int alphabet : {2, 5, 256}) {
+    AdaptiveRadixTree T;
+    std::set<std::string> S;
+    auto randomKey = [&] {
+      std::string key(mt() % 6, ' ');
+      for (auto &c : key) c = (char)(mt() % alphabet);
+      return key;
+    };
+    for (int op = 0; op < 20000; op++) {
+      auto key{randomKey()};
+      if (mt() % 3) {
+        T.insert(key);
+        S.insert(key);
+      } else {
+        T.remove(key);
+        S.erase(key);
+      }
+      assert(T.size() == (int)S.size());
+      assert(T.contains(key) == S.contains(key));
+      auto query{randomKey()};
+      std::string_view longest;
+      for (std::size_t n = 0; n <= query.size(); n++)
+        if (S.contains(query.substr(0, n)))
+          longest = std::string_view(query).substr(0, n);
+      assert(T.longestPrefixOf(query) == longest);
+      if (op % 64 == 0) {
+        auto prefix{query.substr(0, mt() % 3)};
+        std::vector<std::string> expected;
+        for (auto it{S.lower_bound(prefix)};
+             it != S.end() && it->starts_with(prefix); ++it)
+          expected.push_back(*it);
+        assert(T.keysWithPrefix(prefix) == expected);
+      }
+    }
+    for (const auto &key : std::vector(S.begin(), S.end())) T.remove(key);
+    assert(T.empty() && T.root == nullptr);
+  }
+
+  // memory of both tries over URL paths
+  Trie urls;
+  AdaptiveRadixTree compact;
+  auto path = [&] {
+    std::string url{"https://example.com"};
+    for (int depth = 1 + mt() % 4; depth > 0; depth--) {
+      url += "/segment";
+      url += std::to_string(mt() % 50);
+    }
+    return url;
+  };
+  for (int i = 0; i < 5000; i++) {
+    auto url{path()};
+    urls.insert(url);
+    compact.insert(url);
+  }
+  assert(compact.keysWithPrefix("https://") == urls.keysWithPrefix("https://"));
+  std::size_t nodes{0};
+  auto count = [&](auto &self, Trie::Node *x) -> void {
+    nodes++;
+    for (auto next : x->next)
+      if (next) self(self, next);
+  };
+  count(count, urls.root);
+  std::print("{} keys\tTrie {} bytes\tAdaptiveRadixTree {} bytes\n",
+             compact.size(), nodes * sizeof(Trie::Node), compact.bytes());
 }
\ No newline at end of file
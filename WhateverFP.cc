@@ -1,3 +1,11 @@
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <bit>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
 #include "Graph.hh"
 
 // 图可达性
@@ -21,13 +29,15 @@ struct DepthFirstPaths {
     }
   }
 
-  DepthFirstPaths(const Digraph &G, int s)
+  template <isAdjacency Adj>
+  DepthFirstPaths(const Adj &G, int s)
       : marked(G.V, false), edgeTo(G.V, -1), s{s} {
     assert(0 <= s && s < G.V);
     dfs(G, s);
   }
   // 迭代dfs
-  void dfs(const Digraph &G, int s) {
+  template <isAdjacency Adj>
+  void dfs(const Adj &G, int s) {
     marked[s] = true;
     ns::deque<int> stack;
     stack.push_back(s);
@@ -80,14 +90,16 @@ struct BreadthFirstPaths {
         }
     }
   }
-  BreadthFirstPaths(const Digraph &G, int s)
+  template <isAdjacency Adj>
+  BreadthFirstPaths(const Adj &G, int s)
       : marked(G.V, false), edgeTo(G.V, -1), distTo(G.V, 0xff), s{s} {
     assert(0 <= s && s < G.V);
     distTo[s] = 0;
     bfs(G, s);
   }
   // 第二类bfs
-  void bfs(const Digraph &G, int s) {
+  template <isAdjacency Adj>
+  void bfs(const Adj &G, int s) {
     marked[s] = true;
     ns::deque<int> queue;
     queue.push_back(s);
@@ -116,6 +128,151 @@ struct BreadthFirstPaths {
   }
 };
 
+// 方向优化bfs (Beamer)
+// level-synchronous, top-down while the frontier is small, bottom-up once
+// the frontier's out-edges outnumber the edges left to explore
+struct DirectionOptimizingBFS {
+  static constexpr int ALPHA{14}, BETA{24};
+  ns::deque<bool> marked;
+  ns::deque<int> edgeTo, distTo;
+  int s;
+
+  static int concurrency() {
+    return std::max(1, (int)std::thread::hardware_concurrency());
+  }
+
+  // undirected: incoming edges are the outgoing edges
+  DirectionOptimizingBFS(const Graph &G, int s, int threads = concurrency())
+      : DirectionOptimizingBFS(G, G, s, threads) {}
+
+  template <isAdjacency Adj>
+    requires requires(const Adj &G) { G.reverse(); }
+  DirectionOptimizingBFS(const Adj &G, int s, int threads = concurrency())
+      : DirectionOptimizingBFS(G, G.reverse(), s, threads) {}
+
+  // R holds the incoming edges of G, scanned by the bottom-up step
+  template <isAdjacency Adj, isAdjacency Rev>
+  DirectionOptimizingBFS(const Adj &G, const Rev &R, int s, int threads)
+      : marked(G.V, false), edgeTo(G.V, -1), distTo(G.V, 0xff), s{s} {
+    assert(0 <= s && s < G.V);
+    assert(R.V == G.V && threads > 0);
+    distTo[s] = 0;
+    bfs(G, R, threads);
+  }
+
+  template <isAdjacency Adj, isAdjacency Rev>
+  void bfs(const Adj &G, const Rev &R, int threads) {
+    constexpr auto relaxed{std::memory_order_relaxed};
+    int V{G.V}, words{(V + 63) / 64};
+    // parent claims, -1 for undiscovered
+    std::vector<std::atomic<int>> parent(V);
+    for (auto &p : parent) p.store(-1, relaxed);
+    parent[s].store(s, relaxed);
+
+    std::vector<int> queue{s};
+    std::vector<std::vector<int>> next(threads);
+    std::vector<std::uint64_t> frontier(words), nextBits(words);
+    std::atomic<long long> scout{0};
+    std::atomic<int> awake{0};
+    long long unexplored{0};
+    for (int v = 0; v < V; v++) unexplored += G.adj[v].size();
+    bool bottomUp{false}, done{false};
+    int depth{0};
+
+    // runs on one thread once every worker finished the level
+    auto level = [&]() noexcept {
+      long long edges{scout.exchange(0, relaxed)};
+      int vertices{awake.exchange(0, relaxed)};
+      if (bottomUp) {
+        std::swap(frontier, nextBits);
+        std::ranges::fill(nextBits, 0);
+      } else {
+        queue.clear();
+        for (auto &local : next) {
+          queue.insert(queue.end(), local.begin(), local.end());
+          local.clear();
+        }
+      }
+      unexplored -= edges;
+      if (!bottomUp && edges > unexplored / ALPHA) {
+        std::ranges::fill(frontier, 0);
+        for (int v : queue) frontier[v >> 6] |= 1ull << (v & 63);
+        bottomUp = true;
+      } else if (bottomUp && vertices < V / BETA) {
+        queue.clear();
+        for (int w = 0; w < words; w++)
+          for (auto bits{frontier[w]}; bits; bits &= bits - 1)
+            queue.push_back(w * 64 + std::countr_zero(bits));
+        bottomUp = false;
+      }
+      depth++;
+      done = vertices == 0;
+    };
+    std::barrier sync(threads, level);
+
+    auto worker = [&](int t) {
+      while (!done) {
+        long long edges{0};
+        int vertices{0};
+        if (bottomUp) {
+          // whole bitmap words per thread, so nextBits needs no atomics
+          int lo = std::min<long long>(V, 64LL * (words * t / threads));
+          int hi = std::min<long long>(V, 64LL * (words * (t + 1) / threads));
+          for (int v = lo; v < hi; v++) {
+            if (parent[v].load(relaxed) != -1) continue;
+            for (int u : R.adj[v])
+              if (frontier[u >> 6] >> (u & 63) & 1) {
+                parent[v].store(u, relaxed);
+                distTo[v] = depth + 1;
+                nextBits[v >> 6] |= 1ull << (v & 63);
+                vertices++, edges += G.adj[v].size();
+                break;
+              }
+          }
+        } else {
+          long long n = queue.size();
+          for (int i = n * t / threads; i < n * (t + 1) / threads; i++) {
+            int v{queue[i]};
+            for (int w : G.adj[v]) {
+              int expected{-1};
+              if (parent[w].load(relaxed) != -1 ||
+                  !parent[w].compare_exchange_strong(expected, v, relaxed))
+                continue;
+              distTo[w] = depth + 1;
+              next[t].push_back(w);
+              vertices++, edges += G.adj[w].size();
+            }
+          }
+        }
+        scout.fetch_add(edges, relaxed);
+        awake.fetch_add(vertices, relaxed);
+        sync.arrive_and_wait();
+      }
+    };
+    {
+      std::vector<std::jthread> pool;
+      for (int t = 1; t < threads; t++) pool.emplace_back(worker, t);
+      worker(0);
+    }
+
+    for (int v = 0; v < V; v++) {
+      int p{parent[v].load(relaxed)};
+      marked[v] = p != -1;
+      if (v != s) edgeTo[v] = p;
+    }
+  }
+
+  bool hasPathTo(int v) const { return marked[v]; }
+  ns::deque<int> pathTo(int v) const {
+    ns::deque<int> path;
+    if (hasPathTo(v)) {
+      for (int x = v; x != s; x = edgeTo[x]) path.push_front(x);
+      path.push_front(s);
+    }
+    return path;
+  }
+};
+
 template <class P>
 void printPath(const P &p, int v) {
   for (int i = 0; i < v; ++i) {
@@ -150,4 +307,44 @@ int main() {
   std::print("distTo\t");
   for (int v : bfs.distTo) std::print("{}\t", v);
   std::print("\n");
+
+  CSRGraph<int> CSR(DIG);
+  DepthFirstPaths csrdfs(CSR, 0);
+  BreadthFirstPaths csrbfs(CSR, 0);
+  for (int i = 0; i < v; ++i) {
+    assert(csrdfs.edgeTo[i] == dfs.edgeTo[i]);
+    assert(csrbfs.edgeTo[i] == bfs.edgeTo[i]);
+    assert(csrbfs.distTo[i] == bfs.distTo[i]);
+  }
+
+  std::print("\nDirectionOptimizingBFS\n");
+  DirectionOptimizingBFS dobfs(DIG, 0, 4);
+  printPath(dobfs, v);
+
+  // random multigraphs large enough to switch direction both ways
+  constexpr int n{1 << 12};
+  std::mt19937 mt(std::random_device{}());
+  std::uniform_int_distribution randV(0, n - 1);
+  Graph LG(n);
+  Digraph LDG(n);
+  for (int i = 0; i < 4 * n; ++i) {
+    LG.addEdge(randV(mt), randV(mt));
+    LDG.addEdge(randV(mt), randV(mt));
+  }
+  auto check = [](const auto &seq, const auto &par, int V) {
+    for (int i = 0; i < V; ++i) {
+      assert(seq.marked[i] == par.marked[i]);
+      assert(seq.distTo[i] == par.distTo[i]);
+      if (par.marked[i] && i != par.s)
+        assert(par.distTo[par.edgeTo[i]] + 1 == par.distTo[i]);
+    }
+  };
+  // thread counts that do not divide the bitmap words too
+  for (int threads : {1, 2, 3, 4, 5, 6, 7, 8}) {
+    check(BreadthFirstPaths(LG, 0), DirectionOptimizingBFS(LG, 0, threads), n);
+    check(BreadthFirstPaths(LDG, 0), DirectionOptimizingBFS(LDG, 0, threads),
+          n);
+    check(BreadthFirstPaths(LDG, 0),
+          DirectionOptimizingBFS(CSRGraph<int>{LDG}, 0, threads), n);
+  }
 }